@@ -0,0 +1,34 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Minimal timing helpers shared by the micro-benchmarks in bench/.
+namespace bench {
+
+// Keeps the optimizer from discarding a computed result.
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Runs fn(iterations) `runs` times and returns the median time per iteration in ns.
+template <typename Fn>
+double medianNsPerOp(size_t iterations, int runs, Fn fn) {
+    std::vector<double> samples;
+    for (int r = 0; r < runs; r++) {
+        auto start = std::chrono::steady_clock::now();
+        fn(iterations);
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+inline void report(const char* name, double nsPerOp) {
+    std::printf("  %-28s %8.2f ns/op\n", name, nsPerOp);
+}
+
+} // namespace bench
@@ -0,0 +1,114 @@
+// Throughput of many small scripts: one jlite process per script (what a
+// shell loop or xargs -P does) against --batch, which runs each script in
+// its own isolate on a pool of threads inside one process. Both compile
+// every script from source; the code cache is off.
+#include "Batch.h"
+#include "Bench.h"
+#include <fcntl.h>
+#include <fstream>
+#include <spawn.h>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+extern char** environ;
+
+static const size_t SCRIPTS = 200;
+static const int RUNS = 3;
+
+// A few classes, a loop with field traffic and arithmetic, a little output
+static std::string generate(size_t i) {
+    std::string n = std::to_string(i);
+    std::string out;
+    out += "class Point" + n + " {}\n";
+    out += "var p = new Point" + n + "();\n";
+    out += "p.x = " + n + ";\n";
+    out += "p.y = 0;\n";
+    out += "var i = 0;\n";
+    out += "while (i < 2000) {\n";
+    out += "    var q = new Point" + n + "();\n";
+    out += "    q.x = p.x + i;\n";
+    out += "    p.y = p.y + q.x * 2 - i;\n";
+    out += "    i = i + 1;\n";
+    out += "}\n";
+    out += "print \"script " + n + "\";\n";
+    out += "print p.y;\n";
+    return out;
+}
+
+// Keeps at most `jobs` jlite processes running at once
+static bool runProcesses(const std::vector<std::string>& paths, size_t jobs) {
+    posix_spawn_file_actions_t quiet;
+    posix_spawn_file_actions_init(&quiet);
+    posix_spawn_file_actions_addopen(&quiet, 1, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&quiet, 2, "/dev/null", O_WRONLY, 0);
+    bool ok = true;
+    size_t running = 0;
+    auto reap = [&] {
+        int status;
+        if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+        running--;
+    };
+    for (const std::string& path : paths) {
+        if (running == jobs) reap();
+        char* argv[] = {const_cast<char*>(JLITE_BINARY), const_cast<char*>("--no-cache"),
+                        const_cast<char*>(path.c_str()), nullptr};
+        pid_t pid;
+        if (posix_spawn(&pid, JLITE_BINARY, &quiet, nullptr, argv, environ) != 0) return false;
+        running++;
+    }
+    while (running) reap();
+    posix_spawn_file_actions_destroy(&quiet);
+    return ok;
+}
+
+template <typename Fn>
+static double medianScriptsPerSec(Fn fn) {
+    std::vector<double> samples;
+    for (int r = 0; r < RUNS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        samples.push_back(SCRIPTS / s);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+int main() {
+    char dir[] = "/tmp/jlite-batch-XXXXXX";
+    if (!mkdtemp(dir)) return 1;
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < SCRIPTS; i++) {
+        char name[32];
+        std::snprintf(name, sizeof name, "/s%04zu.jlite", i);
+        paths.push_back(dir + std::string(name));
+        std::ofstream(paths.back()) << generate(i);
+    }
+
+    std::ostream discard(nullptr);
+    bool ok = true;
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("Throughput for %zu small scripts (%zu cores):\n", SCRIPTS, cores);
+    for (size_t jobs : {size_t(1), std::max<size_t>(4, cores)}) {
+        double processes = medianScriptsPerSec([&] { ok &= runProcesses(paths, jobs); });
+        double isolates = medianScriptsPerSec([&] {
+            BatchOptions options;
+            options.jobs = jobs;
+            options.configureHeap = [](Heap& heap) { heap.workers.resize(1); };
+            ok &= runBatch(paths, options, discard, discard).failed == 0;
+        });
+        std::printf("  -j %-2zu %-22s %9.0f scripts/s\n", jobs, "process per script", processes);
+        std::printf("  -j %-2zu %-22s %9.0f scripts/s  (%.1fx)\n", jobs, "--batch (isolates)", isolates,
+                    isolates / processes);
+    }
+
+    for (const std::string& path : paths) std::remove(path.c_str());
+    rmdir(dir);
+    if (!ok) {
+        std::printf("error: a script failed\n");
+        return 1;
+    }
+    return 0;
+}
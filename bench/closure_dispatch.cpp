@@ -0,0 +1,72 @@
+// Node dispatch cost: the same loops on the tree-walker, which switches on
+// each node's kind (and on the operator of a Binary) every time it runs
+// it, and on the closure-compiled AST, where each node is one indirect
+// call. The VM is shown for reference.
+#include "Bench.h"
+#include "ClosureCompiler.h"
+#include "Compiler.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "VM.h"
+#include <string>
+
+static const size_t ITERATIONS = 1'000'000;
+
+struct Workload {
+    const char* name;
+    std::string body; // runs once per iteration, with i as the counter
+};
+
+static std::string script(const Workload& w) {
+    return "class Point {}\n"
+           "var p = new Point();\n"
+           "p.x = 0;\n"
+           "p.y = 0;\n"
+           "var sum = 0;\n"
+           "var i = 0;\n"
+           "while (i < " + std::to_string(ITERATIONS) + ") {\n" + w.body + "    i = i + 1;\n}\n";
+}
+
+enum Engine { AST, CLOSURE, VM_ENGINE };
+
+static double run(Engine engine, const std::string& source) {
+    Lexer lexer(source);
+    Arena ast;
+    Parser parser(lexer, ast);
+    auto statements = parser.parse();
+    Resolver resolver;
+    resolver.resolve(statements);
+
+    auto start = std::chrono::steady_clock::now();
+    if (engine == VM_ENGINE) {
+        Compiler compiler;
+        Chunk chunk = compiler.compile(statements);
+        VM machine;
+        machine.interpret(chunk);
+    } else {
+        Interpreter interpreter;
+        if (engine == CLOSURE) ClosureCompiler::run(interpreter, ClosureCompiler(ast).link(statements));
+        else interpreter.interpret(statements);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+}
+
+int main() {
+    const Workload workloads[] = {
+        {"arithmetic", "    sum = sum + i * 2 - i / 4;\n"},
+        {"nested block locals", "    var a = i;\n    {\n        var b = a + 1;\n        { var c = a * b; sum = c - b; }\n    }\n"},
+        {"field access", "    p.x = p.x + 1;\n    p.y = p.x * 2;\n"},
+        {"comparisons", "    var t = i < 10 == i >= 10;\n    var u = sum != i;\n"},
+    };
+    std::printf("%zu iterations, ns/iteration (min of 5):\n", ITERATIONS);
+    std::printf("  %-22s %10s %10s %10s %9s\n", "", "ast", "closure", "vm", "speedup");
+    for (const Workload& w : workloads) {
+        std::string source = script(w);
+        double best[3] = {1e30, 1e30, 1e30};
+        for (int r = 0; r < 5; r++)
+            for (Engine e : {AST, CLOSURE, VM_ENGINE}) best[e] = std::min(best[e], run(e, source));
+        std::printf("  %-22s %10.1f %10.1f %10.1f %8.2fx\n", w.name, best[AST], best[CLOSURE], best[VM_ENGINE],
+                    best[AST] / best[CLOSURE]);
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Block scopes in the tree-walking interpreter: run a loop whose body is a
+// block with locals a million times and check that the heap does not grow
+// with the number of blocks entered. Exits non-zero if it does.
+#include "Bench.h"
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include <malloc.h>
+#include <string>
+
+static const size_t ITERATIONS = 1'000'000;
+static const size_t ALLOWED_GROWTH = 64 * 1024; // allocator noise, not per-block cost
+
+static size_t heapBytesInUse() {
+    return mallinfo2().uordblks;
+}
+
+static std::string script(size_t iterations) {
+    return "var i = 0;\n"
+           "var sum = 0;\n"
+           "while (i < " + std::to_string(iterations) + ") {\n"
+           "    var a = i;\n"
+           "    var b = a + 1;\n"
+           "    { var c = a * b; sum = sum + c - c; }\n"
+           "    i = i + 1;\n"
+           "}\n";
+}
+
+int main() {
+    // Compile both scripts before measuring so only execution is counted.
+    // Tokens point into the source text, so it is kept alive with the AST.
+    std::vector<std::string> sources;
+    Arena ast;
+    sources.reserve(2);
+    auto compile = [&](std::string text) {
+        const std::string& source = sources.emplace_back(std::move(text));
+        Lexer lexer(source);
+        Parser parser(lexer, ast);
+        auto statements = parser.parse();
+        Resolver resolver;
+        resolver.resolve(statements);
+        return statements;
+    };
+    auto warmup = compile(script(1000));
+    auto program = compile(script(ITERATIONS));
+
+    Interpreter interpreter;
+    interpreter.interpret(warmup);
+    size_t before = heapBytesInUse();
+    auto start = std::chrono::steady_clock::now();
+    interpreter.interpret(program);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    size_t after = heapBytesInUse();
+
+    // Two blocks are entered per iteration
+    long growth = long(after) - long(before);
+    std::printf("%zu iterations, %zu block entries:\n", ITERATIONS, 2 * ITERATIONS);
+    std::printf("  %-28s %8.2f ns/iteration\n", "loop with nested block", ns / ITERATIONS);
+    std::printf("  %-28s %8ld bytes (%.2f bytes/block)\n", "heap growth", growth, double(growth) / (2 * ITERATIONS));
+    if (growth > long(ALLOWED_GROWTH)) {
+        std::printf("error: heap grew with the number of blocks entered\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+// A config-style script whose loop body is full of constant expressions,
+// run on both engines with and without the -O1 constant folder. First
+// checks that folding does not change what a few scripts print.
+#include "Bench.h"
+#include "Compiler.h"
+#include "Interpreter.h"
+#include "Optimizer.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "VM.h"
+#include <sstream>
+#include <string>
+
+static const size_t ITERATIONS = 200'000;
+
+static const char* SCRIPT =
+    "var i = 0;\n"
+    "var total = 0;\n"
+    "while (i < 200000) {\n"
+    "    var cacheBytes = 64 * 1024 * 1024;\n"
+    "    var timeout = 60 * 60 * 24 - 1;\n"
+    "    var ratio = 3 / 4 * 100;\n"
+    "    var name = \"service\" + \"-\" + \"primary\";\n"
+    "    var enabled = 1 + 1 == 2;\n"
+    "    var scaled = i * 1 - 0;\n"
+    "    total = total + cacheBytes / 1024 / 1024 + timeout * 0 + ratio * 0;\n"
+    "    i = i + 1;\n"
+    "}\n";
+
+// Folding must leave these printing the same on every engine; signed zero
+// is easy to lose
+static const char* EQUIVALENCE[] = {
+    "print 0;\nprint -0;\nprint 0 * -1;\nprint -0 + 0;\nprint 1 / -0;\nvar z = -0;\nprint z;\n",
+    "var x = 5;\nprint x * 1;\nprint 1 * x;\nprint x + 0;\nprint x - 0;\nprint x / 1;\n",
+    "print 1 + 2 * 3;\nprint 3 / 4 * 100;\nprint 1 + 1 == 2;\nprint \"a\" + \"b\";\nprint \"a\" + \"b\" == \"ab\";\n",
+};
+
+static std::string output(const char* source, bool vm, bool optimize) {
+    Lexer lexer(source);
+    Arena ast;
+    Parser parser(lexer, ast);
+    auto statements = parser.parse();
+    Resolver resolver;
+    resolver.resolve(statements);
+    if (optimize) Optimizer(ast).optimize(statements);
+
+    std::ostringstream out;
+    if (vm) {
+        Compiler compiler;
+        Chunk chunk = compiler.compile(statements);
+        VM machine(out, out);
+        machine.interpret(chunk);
+    } else {
+        Interpreter interpreter(out, out);
+        interpreter.interpret(statements);
+    }
+    return out.str();
+}
+
+static double run(bool vm, bool optimize) {
+    Lexer lexer(SCRIPT);
+    Arena ast;
+    Parser parser(lexer, ast);
+    auto statements = parser.parse();
+    Resolver resolver;
+    resolver.resolve(statements);
+    if (optimize) Optimizer(ast).optimize(statements);
+
+    auto start = std::chrono::steady_clock::now();
+    if (vm) {
+        Compiler compiler;
+        Chunk chunk = compiler.compile(statements);
+        VM machine;
+        machine.interpret(chunk);
+    } else {
+        Interpreter interpreter;
+        interpreter.interpret(statements);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+}
+
+int main() {
+    for (const char* source : EQUIVALENCE) {
+        std::string expected = output(source, false, false);
+        for (bool vm : {false, true}) {
+            for (bool optimize : {false, true}) {
+                if (output(source, vm, optimize) == expected) continue;
+                std::printf("%s -O%d prints differently from ast -O0:\n%s", vm ? "vm" : "ast", int(optimize), source);
+                return 1;
+            }
+        }
+    }
+
+    std::printf("Config-style loop, %zu iterations:\n", ITERATIONS);
+    for (bool vm : {false, true}) {
+        double o0 = run(vm, false), o1 = run(vm, true);
+        std::printf("  %-4s -O0 %8.1f ns/iteration   -O1 %8.1f ns/iteration   (%.2fx)\n", vm ? "vm" : "ast", o0, o1,
+                    o0 / o1);
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+// Full mark and sweep time on a heap of millions of live instances (a
+// 4-ary tree, so there is parallelism to find) for 1, 2, 4 and 8 GC threads.
+#include "Bench.h"
+#include "Runtime.h"
+#include <thread>
+
+static const size_t NODES = 2'000'000;
+static const size_t FANOUT = 4;
+static const int RUNS = 3;
+
+static double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+int main() {
+    // Nothing here registers roots until the tree is built
+    Heap::NoGC noGC;
+
+    auto name = [](const std::string& s) {
+        Value v = Value::string(s);
+        Heap::current().pin(v);
+        return v.asHandle();
+    };
+    size_t nodeClass = name("Node");
+    size_t children[FANOUT];
+    for (size_t i = 0; i < FANOUT; i++) children[i] = name("c" + std::to_string(i));
+
+    // Node i's children are 4i+1 .. 4i+4
+    std::vector<size_t> nodes(NODES);
+    for (size_t i = 0; i < NODES; i++) nodes[i] = Heap::current().allocate<InstanceObject>(Shape::root(nodeClass));
+    for (size_t i = 0; i < NODES; i++) {
+        auto* node = static_cast<InstanceObject*>(Heap::current().get(nodes[i]));
+        for (size_t c = 0; c < FANOUT; c++) {
+            size_t child = FANOUT * i + c + 1;
+            node->setField(children[c], child < NODES ? Value::instance(nodes[child]) : Value::nil());
+        }
+    }
+    Value root = Value::instance(nodes[0]);
+
+    std::printf("Full GC of %zu live instances (%u hardware threads):\n", NODES, std::thread::hardware_concurrency());
+    for (size_t threads : {1, 2, 4, 8}) {
+        Heap::current().workers.resize(threads);
+        std::vector<double> markMs, sweepMs;
+        for (int r = 0; r < RUNS; r++) {
+            auto start = std::chrono::steady_clock::now();
+            Heap::current().mark(root);
+            Heap::current().traceReferences();
+            auto marked = std::chrono::steady_clock::now();
+            Heap::current().sweep();
+            auto swept = std::chrono::steady_clock::now();
+            markMs.push_back(std::chrono::duration<double, std::milli>(marked - start).count());
+            sweepMs.push_back(std::chrono::duration<double, std::milli>(swept - marked).count());
+        }
+        std::printf("  %zu thread%s  mark %8.1f ms   sweep %8.1f ms\n", threads, threads == 1 ? " " : "s",
+                    median(markMs), median(sweepMs));
+    }
+    if (Heap::current().objectCount < NODES) std::printf("error: live objects were swept\n");
+    return 0;
+}
@@ -0,0 +1,109 @@
+// GC pause times for a workload that churns short-lived objects next to a
+// large long-lived object graph, with and without the nursery and with
+// stop-the-world or incremental full collections.
+#include "Bench.h"
+#include "Runtime.h"
+#include <string>
+
+static const size_t LIVE_OBJECTS = 200'000;
+static const size_t CHURN_OBJECTS = 2'000'000;
+static const size_t WINDOW = 64;  // recent temporaries kept alive, like values on the stack
+
+struct BenchRoots : GCRoots {
+    std::vector<Value> values;
+    BenchRoots() { Heap::current().addRoots(this); }
+    ~BenchRoots() { Heap::current().removeRoots(this); }
+    void markRoots() override {
+        for (const Value& v : values) Heap::current().mark(v);
+    }
+};
+
+// Every pause is either a minor collection or part of a full one (a whole
+// stop-the-world collection, or one incremental slice)
+struct Pauses {
+    std::vector<double> minor, full;
+    size_t pausesSeen = Heap::current().pauseCount, minorSeen = Heap::current().minorCollections;
+
+    void record() {
+        if (Heap::current().pauseCount == pausesSeen) return;
+        (Heap::current().minorCollections != minorSeen ? minor : full).push_back(Heap::current().lastPauseMs);
+        pausesSeen = Heap::current().pauseCount;
+        minorSeen = Heap::current().minorCollections;
+    }
+};
+
+static void summarize(const char* kind, std::vector<double> ms) {
+    if (ms.empty()) {
+        std::printf("    %-6s      0 pauses\n", kind);
+        return;
+    }
+    std::sort(ms.begin(), ms.end());
+    double total = 0;
+    for (double m : ms) total += m;
+    std::printf("    %-6s %6zu pauses, median %7.3f ms, p95 %7.3f ms, max %7.3f ms, total %8.1f ms\n",
+                kind, ms.size(), ms[ms.size() / 2], ms[ms.size() * 95 / 100], ms.back(), total);
+}
+
+static void run(const char* label, size_t nurserySize, size_t pauseBudgetUs) {
+    Heap::current().nurserySize = nurserySize;
+    Heap::current().pauseBudgetUs = pauseBudgetUs;
+    Pauses pauses;
+    BenchRoots roots;
+
+    // Pinned like identifiers from the lexer
+    auto name = [](const char* s) {
+        Value v = Value::string(s);
+        Heap::current().pin(v);
+        return v.asHandle();
+    };
+    size_t nodeClass = name("Node"), tempClass = name("Temp");
+    size_t next = name("next"), value = name("value"), extra = name("extra");
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Long-lived graph: a rooted linked list of LIVE_OBJECTS nodes
+    roots.values.push_back(Value::nil());
+    std::vector<size_t> nodes;
+    for (size_t i = 0; i < LIVE_OBJECTS; i++) {
+        size_t addr = Heap::current().allocate<InstanceObject>(Shape::root(nodeClass));
+        pauses.record();
+        auto* node = static_cast<InstanceObject*>(Heap::current().get(addr));
+        node->setField(value, Value::number(double(i)));
+        node->setField(next, roots.values[0]);
+        roots.values[0] = Value::instance(addr);
+        nodes.push_back(addr);
+    }
+
+    // Churn: most temporaries die at once; every 1000th is stored into an
+    // old node, which goes through the write barrier
+    roots.values.resize(1 + WINDOW);
+    for (size_t i = 0; i < CHURN_OBJECTS; i++) {
+        size_t addr = Heap::current().allocate<InstanceObject>(Shape::root(tempClass));
+        pauses.record();
+        auto* temp = static_cast<InstanceObject*>(Heap::current().get(addr));
+        temp->setField(value, Value::number(double(i)));
+        roots.values[1 + i % WINDOW] = Value::instance(addr);
+        if (i % 1000 == 0) {
+            auto* node = static_cast<InstanceObject*>(Heap::current().get(nodes[(i / 1000 * 7919) % nodes.size()]));
+            node->setField(extra, Value::instance(addr));
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("  %s: %.2f s total\n", label, seconds);
+    summarize("minor", pauses.minor);
+    summarize("full", pauses.full);
+
+    // Drop everything before the next configuration
+    roots.values.clear();
+    Heap::current().collectGarbage();
+}
+
+int main() {
+    std::printf("%zu long-lived objects, %zu short-lived allocations:\n", LIVE_OBJECTS, CHURN_OBJECTS);
+    run("256K nursery, incremental full GC (1000 us slices)", 256 * 1024, 1000);
+    run("256K nursery, stop-the-world full GC", 256 * 1024, 0);
+    run("no nursery, incremental full GC (1000 us slices)", 0, 1000);
+    run("no nursery, stop-the-world full GC", 0, 0);
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Lexing throughput in MB/s on a generated multi-megabyte script with a
+// realistic mix of identifiers, keywords, numbers, strings and comments,
+// for each set of scanner kernels the CPU supports, plus the raw speed of
+// each kernel on the kind of run it skips.
+#include "Bench.h"
+#include "Lexer.h"
+#include <string>
+
+static const size_t TARGET_BYTES = 8 * 1024 * 1024;
+static const int RUNS = 5;
+
+static std::string generate() {
+    std::string out;
+    out.reserve(TARGET_BYTES + 256);
+    for (size_t i = 0; out.size() < TARGET_BYTES; i++) {
+        std::string n = std::to_string(i % 200); // a few hundred distinct names, like a real program
+        out += "// update counter " + n + " and its fields\n";
+        out += "var value" + n + " = " + std::to_string(i) + ".5 * (count" + n + " + 42) - 7;\n";
+        out += "while (index" + n + " <= limit" + n + ") {\n";
+        out += "    point" + n + ".x = point" + n + ".x + 1;\n";
+        out += "    index" + n + " = index" + n + " + 1;\n";
+        out += "}\n";
+        out += "print \"finished step " + n + " of the generated workload\";\n";
+        out += "var shape" + n + " = new Shape();\n";
+        out += "if (flag != null) print true; else print false;\n";
+    }
+    return out;
+}
+
+// Commented, deeply indented code with long messages: the long runs the
+// SIMD kernels are for
+static std::string generateVerbose() {
+    std::string out;
+    out.reserve(TARGET_BYTES + 512);
+    std::string indent(12, ' ');
+    for (size_t i = 0; out.size() < TARGET_BYTES; i++) {
+        std::string n = std::to_string(i % 200);
+        out += indent + "// Recompute the running total for bucket " + n + " before the report is printed,\n";
+        out += indent + "// keeping the previous value around so the change can be shown alongside it.\n";
+        out += indent + "var previousTotal" + n + " = runningTotal" + n + ";\n";
+        out += indent + "print \"bucket " + n + ": the running total has been recomputed from all samples seen so far\";\n\n";
+    }
+    return out;
+}
+
+static double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+// GB/s of one kernel over a buffer that is a single long run (the scan
+// stops on the final byte)
+template <typename Scan>
+static double scanGBs(const std::string& run, Scan scan) {
+    std::vector<double> seconds;
+    for (int r = 0; r < RUNS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 20; i++) bench::doNotOptimize(scan(run.data(), run.data() + run.size()));
+        seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / 20);
+    }
+    return double(run.size()) / median(seconds) / 1e9;
+}
+
+static void lexAll(const char* label, const std::string& source) {
+    double mb = double(source.size()) / (1024 * 1024);
+    std::printf("Lexing %.1f MB of %s:\n", mb, label);
+    for (const scan::Kernels* kernels : scan::available()) {
+        size_t tokenCount = 0;
+        std::vector<double> seconds;
+        for (int r = 0; r < RUNS; r++) {
+            auto start = std::chrono::steady_clock::now();
+            Lexer lexer(source, *kernels);
+            std::vector<Token> tokens = lexer.scanTokens();
+            seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            tokenCount = tokens.size();
+            bench::doNotOptimize(tokens);
+        }
+        double s = median(seconds);
+        std::printf("  %-8s %8.1f MB/s  %7.2f ns/token  (%zu tokens)\n", kernels->name, mb / s, s * 1e9 / tokenCount,
+                    tokenCount);
+    }
+}
+
+int main() {
+    lexAll("dense code", generate());
+    lexAll("commented, indented code", generateVerbose());
+
+    // 1 MB runs of each kind, ending in the byte that stops the scan
+    const size_t RUN = 1024 * 1024;
+    std::string blanks(RUN, ' '), comment(RUN, 'x'), text(RUN, 'y'), name(RUN, 'a'), digits(RUN, '7');
+    for (size_t i = 0; i < RUN; i += 80) blanks[i] = '\n', text[i] = '\n';
+    for (size_t i = 0; i < RUN; i += 3) name[i] = '_';
+    blanks.back() = 'x', comment.back() = '\n', text.back() = '"', name.back() = ' ', digits.back() = ';';
+
+    std::printf("\nKernel speed on 1 MB runs (GB/s):\n");
+    std::printf("  %-8s %10s %10s %10s %10s %10s\n", "", "whitespace", "comment", "string", "identifier", "digits");
+    for (const scan::Kernels* k : scan::available()) {
+        int lines = 0;
+        std::printf("  %-8s %10.2f %10.2f %10.2f %10.2f %10.2f\n", k->name,
+                    scanGBs(blanks, [&](const char* p, const char* e) { return k->whitespace(p, e, lines); }),
+                    scanGBs(comment, k->lineEnd),
+                    scanGBs(text, [&](const char* p, const char* e) { return k->stringEnd(p, e, lines); }),
+                    scanGBs(name, k->identifier), scanGBs(digits, k->digits));
+    }
+    return 0;
+}
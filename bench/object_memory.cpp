@@ -0,0 +1,70 @@
+// Per-object memory of many instances of one class, each given the same
+// fields in the same order (so they all end up sharing one Shape).
+#include "Bench.h"
+#include "Runtime.h"
+#include <malloc.h>
+
+static const size_t OBJECTS = 200'000;
+
+// Empty pages the pool keeps cached are malloc'd but hold no objects
+static size_t heapBytesInUse() {
+    return mallinfo2().uordblks - Heap::current().allocator.cachedPages() * PoolAllocator::PAGE_SIZE;
+}
+
+static void run(size_t fieldCount) {
+    // Pinned like identifiers from the lexer, so the sweep below keeps them
+    Value className = Value::string("Point");
+    Heap::current().pin(className);
+    std::vector<size_t> names;
+    for (size_t i = 0; i < fieldCount; i++) {
+        Value name = Value::string("f" + std::to_string(i));
+        Heap::current().pin(name);
+        names.push_back(name.asHandle());
+    }
+
+    std::vector<Value> objects;
+    objects.reserve(OBJECTS);
+    size_t before = heapBytesInUse();
+    auto allocStart = std::chrono::steady_clock::now();
+
+    for (size_t n = 0; n < OBJECTS; n++) {
+        size_t addr = Heap::current().allocate<InstanceObject>(Shape::root(className.asHandle()));
+        auto* obj = static_cast<InstanceObject*>(Heap::current().get(addr));
+        for (size_t i = 0; i < fieldCount; i++) obj->setField(names[i], Value::number(double(n + i)));
+        objects.push_back(Value::instance(addr));
+    }
+
+    double allocNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - allocStart).count();
+    size_t bytes = heapBytesInUse() - before;
+    std::printf("  %zu fields: %7.1f bytes/object incl. handle table (sizeof(InstanceObject) = %zu, %zu shapes so far)\n",
+                fieldCount, double(bytes) / OBJECTS, sizeof(InstanceObject), Shape::count());
+
+    // Unmarked, unpinned objects are all freed
+    auto start = std::chrono::steady_clock::now();
+    Heap::current().sweep();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("            allocate + set fields: %.1f ns/object\n", allocNs / OBJECTS);
+    std::printf("            sweep of %zu dead objects: %.2f ms\n", OBJECTS, ms);
+}
+
+// Steady-state churn: the interpreter allocates short-lived objects and
+// sweeps them in small batches, so freed memory is reused immediately.
+static void churn(size_t batch) {
+    Value className = Value::string("Point");
+    Heap::current().pin(className);
+    for (size_t n = 0; n < batch; n++) {
+        bench::doNotOptimize(Heap::current().allocate<InstanceObject>(Shape::root(className.asHandle())));
+    }
+    Heap::current().sweep();
+}
+
+int main() {
+    // Nothing here registers roots; collection is driven by hand
+    Heap::NoGC noGC;
+    // First, while the handle table is still small enough not to dominate the sweep
+    std::printf("Allocate/sweep churn in batches of 1000:\n");
+    bench::report("allocate + free", bench::medianNsPerOp(1000, 2000, churn));
+    std::printf("Allocating %zu instances of one class:\n", OBJECTS);
+    for (size_t fields : {1, 3, 4, 8}) run(fields);
+    return 0;
+}
@@ -0,0 +1,62 @@
+// A numeric loop (arithmetic and comparisons on numbers only) run on both
+// engines, reporting time per iteration and what each operator site
+// specialized to.
+#include "Bench.h"
+#include "Compiler.h"
+#include "Interpreter.h"
+#include "Isolate.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "VM.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+static const size_t ITERATIONS = 2'000'000;
+
+static const char* SCRIPT =
+    "var i = 0;\n"
+    "var sum = 0;\n"
+    "var x = 0.5;\n"
+    "while (i < 2000000) {\n"
+    "    x = x * 1.000001 + 0.25 / 4 - i * 0.000001;\n"
+    "    sum = sum + x * 2 - 1;\n"
+    "    var inRange = x >= 0;\n"
+    "    i = i + 1;\n"
+    "}\n";
+
+// The feedback registry points into the AST and the chunk, so each run has
+// its own isolate and writes its sites to stats while both are alive
+static double run(bool vm, std::ostream& stats) {
+    Isolate isolate;
+    Isolate::Scope scope(isolate);
+    Lexer lexer(SCRIPT);
+    Arena ast;
+    Parser parser(lexer, ast);
+    auto statements = parser.parse();
+    Resolver resolver;
+    resolver.resolve(statements);
+
+    Chunk chunk;
+    auto start = std::chrono::steady_clock::now();
+    if (vm) {
+        Compiler compiler;
+        chunk = compiler.compile(statements);
+        VM machine;
+        machine.interpret(chunk);
+    } else {
+        Interpreter interpreter;
+        interpreter.interpret(statements);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    BinaryFeedback::dumpStats(stats);
+    return ns / ITERATIONS;
+}
+
+int main() {
+    std::printf("Numeric loop, %zu iterations:\n", ITERATIONS);
+    std::ostringstream stats[2];
+    for (bool vm : {false, true}) std::printf("  %-4s %8.1f ns/iteration\n", vm ? "vm" : "ast", run(vm, stats[vm]));
+    for (bool vm : {false, true}) std::cout << "\n" << (vm ? "vm" : "ast") << " " << stats[vm].str();
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Startup time for a large script: the full front end (what --no-cache and
+// a cold run do), a cold run that also writes the compiled-chunk cache, and
+// a warm run that maps the cache entry instead of lexing, parsing,
+// resolving and compiling.
+#include "Bench.h"
+#include "CodeCache.h"
+#include "Compiler.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Source.h"
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+static const size_t TARGET_BYTES = 8 * 1024 * 1024;
+static const int RUNS = 5;
+
+static std::string generate() {
+    std::string out;
+    out.reserve(TARGET_BYTES + 256);
+    for (size_t i = 0; out.size() < TARGET_BYTES; i++) {
+        std::string n = std::to_string(i);
+        out += "var total" + n + " = " + std::to_string(i % 1000) + " * 3 + 42 - 7;\n";
+        out += "var index" + n + " = 0;\n";
+        out += "while (index" + n + " <= 10) {\n";
+        out += "    var step = index" + n + " * 2;\n";
+        out += "    total" + n + " = total" + n + " + step;\n";
+        out += "    index" + n + " = index" + n + " + 1;\n";
+        out += "}\n";
+        out += "print \"bucket " + std::to_string(i % 50) + " done\";\n";
+    }
+    return out;
+}
+
+static Chunk compile(std::string_view source) {
+    Lexer lexer(source);
+    Arena ast;
+    Parser parser(lexer, ast);
+    auto statements = parser.parse();
+    Resolver resolver;
+    resolver.resolve(statements);
+    Compiler compiler;
+    return compiler.compile(statements);
+}
+
+template <typename Fn>
+static double medianMs(Fn fn) {
+    std::vector<double> samples;
+    for (int r = 0; r < RUNS; r++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+int main() {
+    char dir[] = "/tmp/jlite-startup-XXXXXX";
+    if (!mkdtemp(dir)) return 1;
+    std::string path = std::string(dir) + "/script.jlite";
+    std::ofstream(path) << generate();
+    CodeCache cache(dir);
+
+    size_t codeBytes = 0;
+    double full = medianMs([&] {
+        SourceBuffer source(path);
+        Chunk chunk = compile(source.text());
+        codeBytes = chunk.code.size();
+        bench::doNotOptimize(chunk);
+    });
+    double cold = medianMs([&] {
+        SourceBuffer source(path);
+        std::remove(cache.entryPath(source.text(), 0).c_str());
+        Chunk chunk = compile(source.text());
+        cache.store(source.text(), 0, chunk);
+        bench::doNotOptimize(chunk);
+    });
+    bool hit = true;
+    double warm = medianMs([&] {
+        SourceBuffer source(path);
+        Chunk chunk;
+        hit &= cache.load(source.text(), 0, chunk);
+        bench::doNotOptimize(chunk);
+    });
+
+    SourceBuffer source(path);
+    std::printf("Startup for a %.1f MB script (%zu bytes of bytecode):\n", source.text().size() / (1024.0 * 1024),
+                codeBytes);
+    std::printf("  %-30s %8.1f ms\n", "no cache (front end)", full);
+    std::printf("  %-30s %8.1f ms\n", "cold (front end + store)", cold);
+    std::printf("  %-30s %8.1f ms  (%.1fx faster)\n", "warm (load from cache)", warm, full / warm);
+
+    std::remove(cache.entryPath(source.text(), 0).c_str());
+    std::remove(path.c_str());
+    rmdir(dir);
+    if (!hit) {
+        std::printf("error: the warm run missed the cache\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,326 @@
+// jlite-bench: the regression suite. Generated JLite workloads run end to
+// end (front end and execution, in a fresh isolate per run) on every
+// engine, next to per-phase micro-benchmarks of Lexer::scanTokens,
+// Parser::parse and Heap::sweep. Results are written as JSON with the
+// median and p95 of each case, and can be compared against a baseline
+// written by an earlier run:
+//
+//     jlite-bench --out=base.json                  # on the old build
+//     jlite-bench --baseline=base.json             # on the new one
+//
+// A case whose median is more than --threshold percent (default 10) slower
+// than in the baseline is a regression, and makes the exit status 1.
+#include "Batch.h"
+#include "Bench.h"
+#include "Isolate.h"
+#include "Parser.h"
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace {
+
+struct Result {
+    std::string name;
+    std::string unit;
+    int runs;
+    double median, p95, min;
+};
+
+struct Options {
+    int runs = 7;
+    std::string filter;     // only cases whose name contains this
+    std::string out;        // JSON file; stdout if empty
+    std::string baseline;
+    double threshold = 10;  // percent
+};
+
+// --- Generated workloads ---
+
+std::string arithmetic() {
+    return "var x = 0;\n"
+           "var i = 0;\n"
+           "while (i < 300000) {\n"
+           "    x = x + i * 2 - i / 4;\n"
+           "    var small = x < 1000000;\n"
+           "    i = i + 1;\n"
+           "}\n"
+           "print x;\n";
+}
+
+// Short-lived objects that reference each other: mostly minor collections
+std::string allocationChurn() {
+    return "class Node {}\n"
+           "var keep = new Node();\n"
+           "var i = 0;\n"
+           "while (i < 100000) {\n"
+           "    var n = new Node();\n"
+           "    n.value = i;\n"
+           "    n.next = keep;\n"
+           "    keep.last = n;\n"
+           "    i = i + 1;\n"
+           "}\n"
+           "print keep.last.value;\n";
+}
+
+std::string fieldAccess() {
+    return "class Point {}\n"
+           "var p = new Point();\n"
+           "p.x = 0; p.y = 0; p.z = 0; p.w = 0; p.u = 0; p.v = 0;\n"
+           "var i = 0;\n"
+           "while (i < 150000) {\n"
+           "    p.x = p.y + 1;\n"
+           "    p.y = p.z + p.x;\n"
+           "    p.z = p.w - 1;\n"
+           "    p.u = p.v + p.x;\n"
+           "    p.v = p.u;\n"
+           "    i = i + 1;\n"
+           "}\n"
+           "print p.v;\n";
+}
+
+// Concatenation with interning: a growing string, and short ones that hit
+// the intern table
+std::string stringConcat() {
+    return "var s = \"\";\n"
+           "var i = 0;\n"
+           "while (i < 3000) {\n"
+           "    s = s + \"x\";\n"
+           "    i = i + 1;\n"
+           "}\n"
+           "i = 0;\n"
+           "while (i < 100000) {\n"
+           "    var key = \"key\" + \"value\";\n"
+           "    var longer = key + \"suffix\";\n"
+           "    i = i + 1;\n"
+           "}\n"
+           "print s == s;\n";
+}
+
+// Mostly front end: a large script whose loops never run
+std::string largeFile(size_t bytes = 2 * 1024 * 1024) {
+    std::string out;
+    out.reserve(bytes + 256);
+    for (size_t i = 0; out.size() < bytes; i++) {
+        std::string n = std::to_string(i);
+        out += "var total" + n + " = " + std::to_string(i % 1000) + " * 3 + 42 - 7;\n";
+        out += "var index" + n + " = 10;\n";
+        out += "while (index" + n + " < 10) {\n";
+        out += "    var step = index" + n + " * 2;\n";
+        out += "    total" + n + " = total" + n + " + step;\n";
+        out += "    index" + n + " = index" + n + " + 1;\n";
+        out += "}\n";
+    }
+    return out;
+}
+
+// --- Measurement ---
+
+Result summarize(std::string name, std::string unit, std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    size_t p95 = std::min(samples.size() - 1, (samples.size() * 95 + 99) / 100 - 1); // nearest rank
+    return {std::move(name), std::move(unit), int(samples.size()), samples[samples.size() / 2], samples[p95],
+            samples[0]};
+}
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// One untimed warm-up, then `runs` timed calls of fn, which returns its own
+// duration so it can leave setup out
+Result measure(const std::string& name, int runs, const std::function<double()>& fn) {
+    fn();
+    std::vector<double> samples;
+    for (int r = 0; r < runs; r++) samples.push_back(fn());
+    return summarize(name, "ms", std::move(samples));
+}
+
+Result runWorkload(const std::string& name, const std::string& source, const std::string& engine, int runs) {
+    BatchOptions options;
+    options.engine = engine;
+    CodeCache noCache("");
+    std::ostream discard(nullptr);
+    return measure(name + "/" + engine, runs, [&] {
+        Isolate isolate;
+        Isolate::Scope scope(isolate);
+        isolate.heap.workers.resize(1);
+        auto start = std::chrono::steady_clock::now();
+        if (!runScript(source, options, noCache, discard, discard)) {
+            std::cerr << "error: workload " << name << " failed on " << engine << "\n";
+            std::exit(2);
+        }
+        return msSince(start);
+    });
+}
+
+Result lexer(const std::string& source, int runs) {
+    return measure("micro/lexer-scanTokens", runs, [&] {
+        Isolate isolate; // interned identifiers go away with it, outside the timing
+        Isolate::Scope scope(isolate);
+        auto start = std::chrono::steady_clock::now();
+        Lexer lexer(source);
+        bench::doNotOptimize(lexer.scanTokens());
+        return msSince(start);
+    });
+}
+
+// The parser pulls its tokens from the lexer, so this includes lexing
+Result parser(const std::string& source, int runs) {
+    return measure("micro/parser-parse", runs, [&] {
+        Isolate isolate;
+        Isolate::Scope scope(isolate);
+        auto start = std::chrono::steady_clock::now();
+        Lexer lexer(source);
+        Arena ast;
+        Parser parser(lexer, ast);
+        bench::doNotOptimize(parser.parse());
+        return msSince(start);
+    });
+}
+
+// Sweep of a heap where every object is dead
+Result sweep(int runs) {
+    const size_t OBJECTS = 200000;
+    return measure("micro/heap-sweep", runs, [&] {
+        Isolate isolate;
+        Isolate::Scope scope(isolate);
+        Heap& heap = isolate.heap;
+        heap.workers.resize(1);
+        Value nodeClass = Value::string("Node");
+        Value field = Value::string("value");
+        heap.pin(nodeClass);
+        heap.pin(field);
+        {
+            Heap::NoGC noGC;
+            for (size_t i = 0; i < OBJECTS; i++) {
+                size_t addr = heap.allocate<InstanceObject>(Shape::root(nodeClass.asHandle()));
+                static_cast<InstanceObject*>(heap.get(addr))->setField(field.asHandle(), Value::number(double(i)));
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        heap.sweep();
+        return msSince(start);
+    });
+}
+
+// --- Output and baselines ---
+
+void writeJson(std::ostream& out, const std::vector<Result>& results) {
+    char line[256];
+    out << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        std::snprintf(line, sizeof line,
+                      "    {\"name\": \"%s\", \"unit\": \"%s\", \"runs\": %d, \"median\": %.4f, \"p95\": %.4f, "
+                      "\"min\": %.4f}%s\n",
+                      r.name.c_str(), r.unit.c_str(), r.runs, r.median, r.p95, r.min,
+                      i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+}
+
+// Reads the medians back out of a file written by writeJson, which puts
+// one result per line
+std::map<std::string, double> readBaseline(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot read baseline " + path);
+    std::map<std::string, double> medians;
+    for (std::string line; std::getline(in, line);) {
+        size_t name = line.find("\"name\": \"");
+        size_t median = line.find("\"median\": ");
+        if (name == std::string::npos || median == std::string::npos) continue;
+        name += 9;
+        medians[line.substr(name, line.find('"', name) - name)] = std::strtod(line.c_str() + median + 10, nullptr);
+    }
+    return medians;
+}
+
+// Prints old and new medians side by side; returns the number of regressions
+int compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double threshold) {
+    int regressions = 0;
+    char line[160];
+    std::printf("%-28s %12s %12s %9s\n", "case", "baseline", "current", "change");
+    for (const Result& r : results) {
+        auto it = baseline.find(r.name);
+        if (it == baseline.end()) {
+            std::printf("%-28s %12s %9.3f %s\n", r.name.c_str(), "-", r.median, r.unit.c_str());
+            continue;
+        }
+        double change = (r.median / it->second - 1) * 100;
+        bool regressed = change > threshold;
+        regressions += regressed;
+        std::snprintf(line, sizeof line, "%-28s %9.3f %s %9.3f %s %+8.1f%%%s\n", r.name.c_str(), it->second,
+                      r.unit.c_str(), r.median, r.unit.c_str(), change, regressed ? "  REGRESSION" : "");
+        std::fputs(line, stdout);
+    }
+    return regressions;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--runs=", 0) == 0) options.runs = std::max(1, std::atoi(argv[i] + 7));
+        else if (arg.rfind("--filter=", 0) == 0) options.filter = arg.substr(9);
+        else if (arg.rfind("--out=", 0) == 0) options.out = arg.substr(6);
+        else if (arg.rfind("--baseline=", 0) == 0) options.baseline = arg.substr(11);
+        else if (arg.rfind("--threshold=", 0) == 0) options.threshold = std::atof(argv[i] + 12);
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--runs=N] [--filter=TEXT] [--out=FILE.json] [--baseline=FILE.json] [--threshold=PERCENT]\n";
+            return 1;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    try {
+        if (!options.baseline.empty()) baseline = readBaseline(options.baseline);
+    } catch (std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::vector<Result> results;
+    auto wanted = [&](const std::string& name) {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    };
+    auto add = [&](Result result) {
+        std::cerr << "  " << result.name << ": " << result.median << " " << result.unit << "\n";
+        results.push_back(std::move(result));
+    };
+
+    const std::pair<const char*, std::string> workloads[] = {
+        {"arithmetic", arithmetic()},       {"allocation-churn", allocationChurn()},
+        {"field-access", fieldAccess()},    {"string-concat", stringConcat()},
+        {"large-file", largeFile()},
+    };
+    for (const auto& [name, source] : workloads) {
+        for (const char* engine : {"vm", "closure", "ast"}) {
+            if (wanted(std::string(name) + "/" + engine)) add(runWorkload(name, source, engine, options.runs));
+        }
+    }
+    std::string big = largeFile(4 * 1024 * 1024);
+    if (wanted("micro/lexer-scanTokens")) add(lexer(big, options.runs));
+    if (wanted("micro/parser-parse")) add(parser(big, options.runs));
+    if (wanted("micro/heap-sweep")) add(sweep(options.runs));
+
+    if (options.out.empty()) {
+        if (baseline.empty()) writeJson(std::cout, results);
+    } else {
+        std::ofstream out(options.out);
+        writeJson(out, results);
+        if (!out) {
+            std::cerr << "Error: cannot write " << options.out << "\n";
+            return 1;
+        }
+    }
+    if (!options.baseline.empty() && compare(results, baseline, options.threshold) > 0) return 1;
+    return 0;
+}
@@ -0,0 +1,64 @@
+// Value layout micro-benchmark. Build once with -DJLITE_NAN_BOXING=ON and
+// once with OFF, then compare the two reports.
+#include "Bench.h"
+#include "Runtime.h"
+#include <stdexcept>
+
+static const size_t ITERATIONS = 5'000'000;
+static const int RUNS = 7;
+
+// Mimics the VM: operands are copied from slots onto a stack, type-checked,
+// combined and stored back.
+static void arithmeticLoop(size_t n) {
+    std::vector<Value> slots(256, Value::number(1.0));
+    std::vector<Value> stack;
+    stack.reserve(16);
+    for (size_t i = 0; i < n; i++) {
+        stack.push_back(slots[(i + 1) & 255]);
+        stack.push_back(slots[(i + 7) & 255]);
+        Value b = stack.back(); stack.pop_back();
+        Value a = stack.back(); stack.pop_back();
+        if (!a.isNumber() || !b.isNumber()) throw std::runtime_error("Operands must be numbers.");
+        slots[i & 255] = Value::number(a.asNumber() * 0.5 + b.asNumber() * 0.5);
+    }
+    bench::doNotOptimize(slots);
+}
+
+// obj.y = obj.x + 1 through the heap, the way OP_GET_FIELD/OP_SET_FIELD do it.
+static void fieldLoop(size_t n) {
+    size_t addr = Heap::current().allocate<InstanceObject>(Shape::root(Value::string("Point").asHandle()));
+    Value obj = Value::instance(addr);
+    auto* io = static_cast<InstanceObject*>(Heap::current().get(obj.asHandle()));
+    const size_t x = Value::string("x").asHandle(), y = Value::string("y").asHandle();
+    io->setField(x, Value::number(1));
+    io->setField(y, Value::number(0));
+    for (size_t i = 0; i < n; i++) {
+        auto* inst = static_cast<InstanceObject*>(Heap::current().get(obj.asHandle()));
+        Value v;
+        inst->getField(x, v);
+        inst->setField(y, Value::number(v.asNumber() + 1));
+    }
+    bench::doNotOptimize(io->inlineSlots);
+}
+
+// Variable reads of string values copy the Value, as Environment::get does.
+static void stringCopyLoop(size_t n) {
+    std::vector<Value> strings;
+    for (int i = 0; i < 64; i++) strings.push_back(Value::string("a moderately long string value #" + std::to_string(i)));
+    std::vector<Value> slots(256);
+    for (size_t i = 0; i < n; i++) {
+        slots[i & 255] = strings[i & 63];
+    }
+    bench::doNotOptimize(slots);
+}
+
+int main() {
+    // Nothing here registers roots; collection is driven by hand
+    Heap::NoGC noGC;
+    std::printf("Value layout: %s, sizeof(Value) = %zu bytes\n",
+                JLITE_NAN_BOXING ? "NaN-boxed" : "tagged variant", sizeof(Value));
+    bench::report("arithmetic loop", bench::medianNsPerOp(ITERATIONS, RUNS, arithmeticLoop));
+    bench::report("field access loop", bench::medianNsPerOp(ITERATIONS, RUNS, fieldLoop));
+    bench::report("string value copy", bench::medianNsPerOp(ITERATIONS, RUNS, stringCopyLoop));
+    return 0;
+}
@@ -1,99 +1,151 @@
 #pragma once
 #include "Token.h"
-#include <memory>
+#include "InlineCache.h"
+#include "TypeFeedback.h"
+#include <cstdint>
+#include <string>
 #include <vector>
 
-// Forward declarations
-struct Expr;
-struct Stmt;
+// AST nodes are plain structs bump-allocated in the Arena of the compilation
+// that parsed them (see Parser), so none of them owns anything: children are
+// raw pointers, child lists are arena arrays and names are the interned
+// string Values from the lexer. Every node starts with a kind tag; passes
+// switch on it and static_cast to the concrete node.
+
+enum class ExprKind : uint8_t { BINARY, LITERAL, VARIABLE, ASSIGN, NEW, GET, SET, CALL };
+enum class StmtKind : uint8_t { EXPRESSION, PRINT, VAR, WHILE, BLOCK, FUNCTION, CLASS };
+
+// An arena array of child nodes
+template <typename T>
+struct NodeList {
+    T** items = nullptr;
+    uint32_t count = 0;
+
+    T** begin() const { return items; }
+    T** end() const { return items + count; }
+    size_t size() const { return count; }
+};
 
 // --- Expressions ---
 struct Expr {
-    virtual ~Expr() = default;
+    const ExprKind kind;
+    explicit Expr(ExprKind kind) : kind(kind) {}
 };
 
+// Unary operators are a Binary without a left operand. The site's source
+// line is feedback.line.
 struct Binary : Expr {
-    std::shared_ptr<Expr> left, right;
-    Token op;
-    Binary(std::shared_ptr<Expr> l, Token o, std::shared_ptr<Expr> r) : left(l), op(o), right(r) {}
+    Expr* left;
+    Expr* right;
+    TokenType op;
+    BinaryFeedback feedback;
+    Binary(Expr* l, const Token& o, Expr* r)
+        : Expr(ExprKind::BINARY), left(l), right(r), op(o.type), feedback(o.type, o.line) {}
 };
 
 struct Literal : Expr {
-    std::variant<std::monostate, double, std::string, bool> value;
-    
-    Literal(std::variant<std::monostate, double, std::string, bool> v) : value(v) {}
+    Value value;
+    Literal(Value v) : Expr(ExprKind::LITERAL), value(v) {}
 };
 
+// Resolved by the Resolver: depth is the number of enclosing block scopes
+// to walk out (-1 for a global), slot is the index within that scope.
 struct Variable : Expr {
-    Token name;
-    Variable(Token n) : name(n) {}
+    Value name;
+    int line;
+    int depth = -1;
+    int slot = -1;
+    Variable(const Token& n) : Expr(ExprKind::VARIABLE), name(n.literal), line(n.line) {}
 };
 
 struct Assign : Expr {
-    Token name;
-    std::shared_ptr<Expr> value;
-    Assign(Token n, std::shared_ptr<Expr> v) : name(n), value(v) {}
+    Value name;
+    int line;
+    int depth = -1;
+    int slot = -1;
+    Expr* value;
+    Assign(Value n, int line, Expr* v) : Expr(ExprKind::ASSIGN), name(n), line(line), value(v) {}
 };
 
 struct New : Expr {
-    Token className;
-    New(Token name) : className(name) {} 
+    Value className;
+    int line;
+    New(const Token& name) : Expr(ExprKind::NEW), className(name.literal), line(name.line) {}
 };
 
+// The site's source line is ic.line
 struct Get : Expr {
-    std::shared_ptr<Expr> object;
-    Token name;
-    Get(std::shared_ptr<Expr> obj, Token n) : object(obj), name(n) {}
+    Expr* object;
+    Value name;
+    InlineCache ic;
+    Get(Expr* obj, const Token& n) : Expr(ExprKind::GET), object(obj), name(n.literal), ic(InlineCache::GET, n.line) {}
 };
 
 struct Set : Expr {
-    std::shared_ptr<Expr> object;
-    Token name;
-    std::shared_ptr<Expr> value;
-    Set(std::shared_ptr<Expr> obj, Token n, std::shared_ptr<Expr> v) : object(obj), name(n), value(v) {}
+    Expr* object;
+    Value name;
+    Expr* value;
+    InlineCache ic;
+    Set(Expr* obj, Value n, int line, Expr* v) : Expr(ExprKind::SET), object(obj), name(n), value(v), ic(InlineCache::SET, line) {}
 };
 
 struct Call : Expr {
-    std::shared_ptr<Expr> callee;
-    std::vector<std::shared_ptr<Expr>> arguments;
-    Call(std::shared_ptr<Expr> c, std::vector<std::shared_ptr<Expr>> args) : callee(c), arguments(args) {}
+    Expr* callee;
+    NodeList<Expr> arguments;
+    Call(Expr* c, NodeList<Expr> args) : Expr(ExprKind::CALL), callee(c), arguments(args) {}
 };
 
 // --- Statements ---
+// line is where the statement starts: its keyword, name or first token
 struct Stmt {
-    virtual ~Stmt() = default;
+    const StmtKind kind;
+    int line;
+    Stmt(StmtKind kind, int line) : kind(kind), line(line) {}
 };
 
 struct ExpressionStmt : Stmt {
-    std::shared_ptr<Expr> expression;
-    ExpressionStmt(std::shared_ptr<Expr> e) : expression(e) {}
+    Expr* expression;
+    ExpressionStmt(Expr* e, int line) : Stmt(StmtKind::EXPRESSION, line), expression(e) {}
 };
 
 struct PrintStmt : Stmt {
-    std::shared_ptr<Expr> expression;
-    PrintStmt(std::shared_ptr<Expr> e) : expression(e) {}
+    Expr* expression;
+    PrintStmt(Expr* e, int line) : Stmt(StmtKind::PRINT, line), expression(e) {}
 };
 
 struct VarStmt : Stmt {
-    Token name;
-    std::shared_ptr<Expr> initializer;
-    VarStmt(Token n, std::shared_ptr<Expr> i) : name(n), initializer(i) {}
+    Value name;
+    int slot = -1; // global index at top level, otherwise slot in the enclosing block
+    Expr* initializer;
+    VarStmt(const Token& n, Expr* i) : Stmt(StmtKind::VAR, n.line), name(n.literal), initializer(i) {}
+};
+
+struct WhileStmt : Stmt {
+    Expr* condition;
+    Stmt* body;
+    WhileStmt(Expr* c, Stmt* b, int line) : Stmt(StmtKind::WHILE, line), condition(c), body(b) {}
 };
 
 struct Block : Stmt {
-    std::vector<std::shared_ptr<Stmt>> statements;
-    Block(std::vector<std::shared_ptr<Stmt>> s) : statements(s) {}
+    NodeList<Stmt> statements;
+    int slotCount = 0; // number of distinct locals declared directly in this block
+    Block(NodeList<Stmt> s, int line) : Stmt(StmtKind::BLOCK, line), statements(s) {}
 };
 
 struct Function : Stmt {
-    Token name;
-    std::vector<Token> params;
-    std::vector<std::shared_ptr<Stmt>> body;
-    Function(Token n, std::vector<Token> p, std::vector<std::shared_ptr<Stmt>> b) : name(n), params(p), body(b) {}
+    Value name;
+    const Value* params; // interned names, paramCount of them
+    uint32_t paramCount;
+    NodeList<Stmt> body;
+    Function(const Token& n, const Value* p, uint32_t count, NodeList<Stmt> b)
+        : Stmt(StmtKind::FUNCTION, n.line), name(n.literal), params(p), paramCount(count), body(b) {}
 };
 
 struct ClassStmt : Stmt {
-    Token name;
-    std::vector<std::shared_ptr<Function>> methods;
-    ClassStmt(Token n, std::vector<std::shared_ptr<Function>> m) : name(n), methods(m) {}
+    Value name;
+    NodeList<Function> methods;
+    ClassStmt(const Token& n, NodeList<Function> m) : Stmt(StmtKind::CLASS, n.line), name(n.literal), methods(m) {}
 };
+
+// Prints the tree as indented s-expressions (--dump-ast)
+void dumpAst(const std::vector<Stmt*>& statements, const std::string& name);
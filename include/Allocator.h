@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Size-class pool allocator backing every HeapObject.
+//
+// Each size class owns 64KB pages carved into equal cells. A page hands out
+// cells by bumping a pointer until it is full and afterwards from its own
+// free list, which Heap::sweep refills as it frees dead objects. Objects
+// allocated together therefore sit next to each other instead of wherever
+// malloc put them. Anything bigger than the largest class goes to malloc.
+class PoolAllocator {
+public:
+    static constexpr size_t PAGE_SIZE = 64 * 1024;
+    static constexpr size_t CLASS_COUNT = 9;
+    static constexpr size_t CLASS_SIZES[CLASS_COUNT] = {16, 32, 48, 64, 80, 96, 128, 192, 256};
+    static constexpr uint8_t LARGE = 0xFF; // size class of malloc'd objects
+
+    ~PoolAllocator();
+
+    // Returns uninitialized memory for `size` bytes and the size class it came from
+    void* allocate(size_t size, uint8_t& sizeClass);
+    void free(void* ptr, uint8_t sizeClass);
+
+    // Called after a sweep: pages with no live cells go to a shared cache any
+    // size class can reuse, and the cache beyond what the heap could regrow
+    // into soon is handed back to the system.
+    void releaseEmptyPages();
+
+    // Pages, fragmentation and bytes live, one line per size class in use
+    void dumpStats(std::ostream& out) const;
+
+    // Bytes a block occupies: its cell size, or the requested size for large objects
+    static size_t blockSize(const void* ptr, uint8_t sizeClass);
+
+    size_t liveBytes() const;
+    size_t cachedPages() const { return emptyPages.size(); }
+
+private:
+    struct FreeCell { FreeCell* next; };
+
+    struct Page {
+        uint32_t cellSize;
+        uint32_t cellCount;
+        uint32_t liveCells = 0;
+        bool available = false;   // on its class's list of pages with room
+        char* bump;               // first never-used cell
+        char* end;
+        FreeCell* freeList = nullptr;
+    };
+
+    struct SizeClass {
+        std::vector<Page*> pages;
+        std::vector<Page*> available; // pages that may still have free cells
+    };
+
+    SizeClass classes[CLASS_COUNT];
+    std::vector<void*> emptyPages;
+    size_t largeCount = 0;
+    size_t largeBytes = 0;
+
+    static constexpr uint8_t classFor(size_t size) {
+        for (uint8_t i = 0; i < CLASS_COUNT; i++) {
+            if (size <= CLASS_SIZES[i]) return i;
+        }
+        return LARGE;
+    }
+    void* allocateSlow(size_t size, uint8_t sizeClass);
+    static Page* pageOf(void* ptr) {
+        return reinterpret_cast<Page*>(reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t)(PAGE_SIZE - 1));
+    }
+    Page* newPage(uint8_t sizeClass);
+};
+
+// Fast path: the most recently used page of the class still has a cell
+inline void* PoolAllocator::allocate(size_t size, uint8_t& sizeClass) {
+    sizeClass = classFor(size);
+    if (sizeClass != LARGE && !classes[sizeClass].available.empty()) {
+        Page* page = classes[sizeClass].available.back();
+        if (FreeCell* cell = page->freeList) {
+            page->freeList = cell->next;
+            page->liveCells++;
+            return cell;
+        }
+        if (page->bump < page->end) {
+            void* cell = page->bump;
+            page->bump += page->cellSize;
+            page->liveCells++;
+            return cell;
+        }
+    }
+    return allocateSlow(size, sizeClass);
+}
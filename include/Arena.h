@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator for objects that all die together, such as the AST of one
+// compilation. Nothing is freed individually and no destructors run, so only
+// trivially destructible types may be allocated here.
+class Arena {
+public:
+    Arena() = default;
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align) {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(cursor) + align - 1) & ~uintptr_t(align - 1);
+        if (p + size > reinterpret_cast<uintptr_t>(limit)) return allocateSlow(size, align);
+        cursor = reinterpret_cast<char*>(p + size);
+        bytes += size;
+        return reinterpret_cast<void*>(p);
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        objects++;
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Copies items[0, count) into the arena
+    template <typename T>
+    T* copy(const T* items, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "arena arrays are copied bytewise");
+        if (count == 0) return nullptr;
+        T* out = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; i++) out[i] = items[i];
+        return out;
+    }
+
+    // Drops everything allocated so far, keeping the first chunk for reuse
+    void reset();
+
+    size_t objectCount() const { return objects; }  // make() calls
+    size_t bytesUsed() const { return bytes; }       // handed out, excluding chunk slack
+    size_t bytesReserved() const;                    // chunk memory held
+
+private:
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+    struct Chunk {
+        char* memory;
+        size_t size;
+    };
+    std::vector<Chunk> chunks;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t objects = 0;
+    size_t bytes = 0;
+
+    void* allocateSlow(size_t size, size_t align);
+};
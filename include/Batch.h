@@ -0,0 +1,38 @@
+#pragma once
+#include "CodeCache.h"
+#include "Runtime.h"
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct BatchOptions {
+    std::string engine = "vm";  // vm, ast or closure
+    int optLevel = 0;
+    size_t jobs = 1;            // threads running scripts
+    std::string cacheDirectory; // empty: no code cache
+    std::function<void(Heap&)> configureHeap; // GC settings for each script's heap
+};
+
+struct BatchResult {
+    size_t scripts = 0;
+    size_t failed = 0;  // stopped on a scan, parse, resolve or runtime error
+};
+
+// Runs one script in the current isolate, printing to out and reporting
+// errors to err. Returns false if it stopped on an error.
+bool runScript(std::string_view source, const BatchOptions& options, const CodeCache& cache, std::ostream& out,
+               std::ostream& err);
+
+// Runs scripts concurrently (--batch DIR -j N), each in a fresh Isolate on
+// one of options.jobs threads. A script's output and errors are captured
+// and written once it and every script before it have finished, so the
+// result does not depend on scheduling: output under a "==> path <==" line
+// to out, each error line prefixed with the path to err.
+BatchResult runBatch(const std::vector<std::string>& paths, const BatchOptions& options, std::ostream& out,
+                     std::ostream& err);
+
+// The *.jlite files in a directory, sorted by name. Throws std::runtime_error
+// if it cannot be read.
+std::vector<std::string> listScripts(const std::string& directory);
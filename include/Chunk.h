@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Runtime.h"
+#include "InlineCache.h"
+#include "TypeFeedback.h"
+
+// Bytecode instruction set for the VM.
+// Operand widths: constant-pool, global, cache indices and jump offsets are
+// 24-bit, local slots are 16-bit. Slots are assigned by the Resolver.
+enum OpCode : uint8_t {
+    OP_CONSTANT,        // [k24]  push constants[k]
+    OP_NIL, OP_TRUE, OP_FALSE,
+    OP_POP,
+    OP_POPN,            // [n16]  pop n values (block exit)
+
+    OP_DEFINE_GLOBAL,   // [g24]  globals[g] = pop
+    OP_GET_GLOBAL,      // [g24]
+    OP_SET_GLOBAL,      // [g24]  value stays on stack
+    OP_GET_LOCAL,       // [s16]
+    OP_SET_LOCAL,       // [s16]  value stays on stack
+
+    OP_CLASS,           // [k24]  declare class by name
+    OP_NEW,             // [k24]  instantiate class by name
+    OP_GET_FIELD,       // [k24 c24]  obj -> obj.name, through caches[c]
+    OP_SET_FIELD,       // [k24 c24]  obj value -> value, through caches[c]
+
+    OP_ADD, OP_SUBTRACT, OP_MULTIPLY, OP_DIVIDE,     // [f24]  a b -> a op b, type feedback in feedback[f]
+    OP_NEGATE, OP_NOT,
+    OP_EQUAL, OP_NOT_EQUAL,
+    OP_GREATER, OP_GREATER_EQUAL, OP_LESS, OP_LESS_EQUAL,  // [f24]
+
+    // Quickened forms the VM rewrites the [f24] ops into once their site has
+    // seen its operand types. Each guards on those types and rewrites itself
+    // back to the generic op if the guard fails.
+    OP_ADD_NUM, OP_SUBTRACT_NUM, OP_MULTIPLY_NUM, OP_DIVIDE_NUM,
+    OP_GREATER_NUM, OP_GREATER_EQUAL_NUM, OP_LESS_NUM, OP_LESS_EQUAL_NUM,
+    OP_ADD_STR,
+
+    OP_JUMP_IF_FALSE,   // [o24]  pop condition, skip forward o bytes if falsey
+    OP_LOOP,            // [o24]  jump back o bytes
+
+    OP_PRINT,
+    OP_RETURN
+};
+
+const char* opName(uint8_t op); // "OP_ADD", or "OP_UNKNOWN"
+
+// A flat unit of compiled code with its constant pool.
+struct Chunk {
+    std::vector<uint8_t> code;
+    std::vector<int> lines;         // source line per byte of code
+    std::vector<Value> constants;
+    std::vector<std::string> globalNames;  // for disassembly only
+    std::vector<InlineCache> caches;       // one per field access site, updated by the VM
+    std::vector<BinaryFeedback> feedback;  // one per arithmetic/relational site, updated by the VM
+
+    void write(uint8_t byte, int line) {
+        code.push_back(byte);
+        lines.push_back(line);
+    }
+
+    size_t addConstant(Value value) {
+        constants.push_back(value);
+        return constants.size() - 1;
+    }
+
+    void disassemble(const std::string& name) const;
+    size_t disassembleInstruction(size_t offset) const;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include "AST.h"
+#include "Arena.h"
+#include "Interpreter.h"
+#include <vector>
+
+// Closure-compiled form of the AST (--engine=closure). A one-time link step
+// turns every node into a function pointer bound to its children and to
+// what the node's kind, operator and resolved scope decide statically, so
+// running a node is a single indirect call with no switch on its kind or
+// operator. The closures run on an Interpreter's globals, block scopes and
+// GC roots, with the same semantics as the tree-walker.
+struct ExprClosure;
+struct StmtClosure;
+using EvalFn = Value (*)(ExprClosure* self, Interpreter& in);
+using ExecFn = void (*)(StmtClosure* self, Interpreter& in);
+
+// Operator closures rewrite eval in place as their site's type feedback
+// specializes and deoptimizes.
+struct ExprClosure {
+    EvalFn eval;
+    ExprClosure* left = nullptr;   // operand, object or assigned value
+    ExprClosure* right = nullptr;
+    Value value;                   // literal, class name or field name
+    int depth = -1;
+    int slot = -1;
+    InlineCache* ic = nullptr;            // the Get/Set node's cache
+    BinaryFeedback* feedback = nullptr;   // the Binary node's type feedback
+    ExprKind kind;                        // of the node, for --stats
+
+    ExprClosure(EvalFn eval, ExprKind kind) : eval(eval), kind(kind) {}
+};
+
+struct StmtClosure {
+    ExecFn exec;
+    ExprClosure* expr = nullptr;   // expression, initializer or condition
+    StmtClosure* body = nullptr;   // loop body
+    NodeList<StmtClosure> statements;
+    int slot = -1;                 // variable slot, or the block's slot count
+    ClassStmt* declaration = nullptr;
+    StmtKind kind;                 // for --stats
+    int line;                      // for the shadow stack
+
+    StmtClosure(ExecFn exec, StmtKind kind, int line) : exec(exec), kind(kind), line(line) {}
+};
+
+// Links a resolved (and optionally optimized) AST. The closures are
+// allocated in the given arena and point into the AST, so both must outlive
+// them. A program linked with profile keeps the running interpreter's
+// shadow stack, which must be set; one linked without pays nothing for it.
+class ClosureCompiler {
+public:
+    explicit ClosureCompiler(Arena& arena, bool profile = false) : arena(arena), profile(profile) {}
+    std::vector<StmtClosure*> link(const std::vector<Stmt*>& statements);
+
+    // Runs a linked program, reporting a runtime error like Interpreter::interpret
+    static bool run(Interpreter& interpreter, const std::vector<StmtClosure*>& program);
+
+private:
+    Arena& arena;
+    bool profile;
+    int blockDepth = 0; // declarations outside any block are globals
+
+    ExprClosure* linkExpr(Expr* expr);
+    StmtClosure* linkStmt(Stmt* stmt);
+};
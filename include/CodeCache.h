@@ -0,0 +1,34 @@
+#pragma once
+#include "Chunk.h"
+#include <string>
+#include <string_view>
+
+// On-disk cache of compiled chunks, so a script that has not changed skips
+// the lexer, parser, resolver and compiler on later runs. Entries are keyed
+// by a hash of the source text and the optimization level, and record the
+// cache format version and the interpreter's version and build options; an
+// entry that is stale, from another build, truncated or fails its checksum
+// is ignored and overwritten by the next store().
+class CodeCache {
+public:
+    // An empty directory disables the cache
+    explicit CodeCache(std::string directory);
+
+    // $JLITE_CACHE_DIR, else $XDG_CACHE_HOME/jlite, else ~/.cache/jlite
+    static std::string defaultDirectory();
+
+    // Fills chunk and returns true if there is a valid entry for source
+    bool load(std::string_view source, int optLevel, Chunk& chunk) const;
+
+    // Writes chunk, which must not have run yet (the VM rewrites its code
+    // and fills its caches). Failures are silent: the cache is an optimization.
+    void store(std::string_view source, int optLevel, const Chunk& chunk) const;
+
+    // The file the entry for source is stored in
+    std::string entryPath(std::string_view source, int optLevel) const;
+
+private:
+    std::string directory;
+
+    std::string entryPath(uint64_t sourceHash, int optLevel) const;
+};
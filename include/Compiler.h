@@ -0,0 +1,41 @@
+#pragma once
+#include "AST.h"
+#include "Chunk.h"
+#include <unordered_map>
+
+// Lowers the Stmt/Expr trees produced by Parser::parse() into a Chunk.
+// Expects the Resolver to have run: block locals become absolute stack
+// slots and globals become indices into the VM's global array.
+class Compiler {
+public:
+    Chunk compile(const std::vector<Stmt*>& statements);
+
+private:
+    struct Scope {
+        int base;    // stack slot of the block's first local
+        int pushed;  // locals materialized on the stack so far
+    };
+
+    Chunk chunk;
+    std::vector<Scope> scopes;
+    int line = 0;
+    std::unordered_map<size_t, size_t> stringConstants; // interned handle -> index
+    std::unordered_map<uint64_t, size_t> numberConstants; // bit pattern -> index: -0 and 0 stay apart
+
+    void compileStmt(Stmt* stmt);
+    void compileExpr(Expr* expr);
+
+    int localSlot(int depth, int slot) const;
+
+    // Emit helpers
+    void emit(uint8_t byte);
+    void emitIndex(OpCode op, size_t index);  // op + 24-bit operand
+    void emitSlot(OpCode op, size_t slot);    // op + 16-bit operand
+    void emitField(OpCode op, Value name, int siteLine);
+    void emitBinary(OpCode op, TokenType token);
+    size_t emitJump(OpCode op);               // returns the operand offset to patch
+    void patchJump(size_t operand);
+    void emitLoop(size_t loopStart);
+    size_t stringConstant(const Value& str);
+    size_t numberConstant(double value);
+};
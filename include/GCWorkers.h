@@ -0,0 +1,35 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork-join pool for the collector. run() hands the same job to every
+// participant (index 0 is the calling thread, the rest are parked worker
+// threads) and returns once all of them have finished it.
+class GCWorkerPool {
+public:
+    ~GCWorkerPool();
+
+    // Total participants, including the caller. Threads start on first use.
+    void resize(size_t participants);
+    size_t size() const { return participants; }
+
+    void run(const std::function<void(size_t)>& job);
+
+private:
+    size_t participants = 1;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(size_t)>* job = nullptr;
+    size_t round = 0;      // bumped for every run() so parked threads know to start
+    size_t pending = 0;    // worker threads still inside the current job
+    bool stopping = false;
+
+    void stop();
+    void workerLoop(size_t index);
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include "Runtime.h"
+#include <iosfwd>
+
+// Per-site cache for field reads and writes. Remembers up to POLY_MAX
+// shapes seen at the site together with the slot they resolve to; a site
+// that sees more shapes than that goes megamorphic and stops caching.
+struct InlineCache {
+    enum Kind : uint8_t { GET, SET };
+    enum State : uint8_t { UNINITIALIZED, MONOMORPHIC, POLYMORPHIC, MEGAMORPHIC };
+    static constexpr int POLY_MAX = 4;
+
+    struct Entry {
+        Shape* shape;
+        Shape* next;   // SET only: shape after adding the field, nullptr if it already exists
+        int slot;      // -1 on a GET entry caches "field absent"
+    };
+
+    Kind kind;
+    State state = UNINITIALIZED;
+    uint8_t count = 0;
+    int line;
+    Entry entries[POLY_MAX];
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    InlineCache(Kind kind, int line) : kind(kind), line(line) {}
+
+    Value get(InstanceObject* obj, size_t name) {
+        Shape* shape = obj->shape;
+        for (int i = 0; i < count; i++) {
+            if (entries[i].shape == shape) {
+                hits++;
+                return entries[i].slot >= 0 ? obj->slot(entries[i].slot) : Value::nil();
+            }
+        }
+        return getMiss(obj, name);
+    }
+
+    void set(InstanceObject* obj, size_t name, const Value& value) {
+        Heap::current().writeBarrier(obj, value);
+        Shape* shape = obj->shape;
+        for (int i = 0; i < count; i++) {
+            if (entries[i].shape == shape) {
+                hits++;
+                if (entries[i].next) obj->appendSlot(entries[i].next, value);
+                else obj->slot(entries[i].slot) = value;
+                return;
+            }
+        }
+        setMiss(obj, name, value);
+    }
+
+    // Prints every site that has executed, ordered by source line
+    static void dumpStats(std::ostream& out);
+
+private:
+    Value getMiss(InstanceObject* obj, size_t name);
+    void setMiss(InstanceObject* obj, size_t name, const Value& value);
+    void addEntry(Entry entry);
+};
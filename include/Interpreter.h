@@ -1,34 +1,74 @@
 #pragma once
 #include "AST.h"
+#include "Profiler.h"
 #include "Runtime.h"
+#include "Stats.h"
+#include <iostream>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
+// Slots are assigned by the Resolver, so a block scope is a flat array of
+// values. The array belongs to the interpreter's ScopeStack and the
+// Environment itself lives on the C++ stack; both go away when the block exits.
 class Environment {
 public:
     Environment* enclosing;
-    std::unordered_map<std::string, Value> values;
+    Value* values;
+    size_t size;
 
-    Environment(Environment* enclosing = nullptr) : enclosing(enclosing) {}
+    Environment(Environment* enclosing, Value* values, size_t size) : enclosing(enclosing), values(values), size(size) {}
 
-    void define(std::string name, Value value);
-    void assign(Token name, Value value);
-    Value get(Token name);
+    void define(int slot, Value value);
+    void assign(int depth, int slot, Value value);
+    Value get(int depth, int slot);
+    Environment* ancestor(int depth);
 };
 
-class Interpreter {
+// Backing store for block scopes. Blocks nest, so slots are handed out and
+// given back in stack order. Storage is a list of fixed-size chunks that
+// never move, which keeps every live Environment::values pointer valid as
+// the stack grows. Once the deepest nesting has been seen, entering a block
+// allocates nothing.
+class ScopeStack {
 public:
-    Environment* globals;
-    Environment* environment;
-    std::unordered_map<std::string, std::shared_ptr<ClassStmt>> classes;
+    Value* push(size_t count);
+    void pop(size_t count);
 
-    Interpreter();
-    void interpret(const std::vector<std::shared_ptr<Stmt>>& statements);
+private:
+    static constexpr size_t CHUNK_SLOTS = 1024;
+    struct Chunk {
+        std::unique_ptr<Value[]> values;
+        size_t capacity;
+        size_t used = 0;
+    };
+    std::vector<Chunk> chunks;
+    size_t current = 0;
+};
+
+class Interpreter : public GCRoots {
+public:
+    Heap& heap;        // of the isolate the interpreter was created in
+    Stats& stats;      // ... and its counters
+    std::ostream& out; // print statements
+    std::ostream& err; // runtime errors
+    std::vector<Value> globals;
+    Environment* environment = nullptr; // innermost block scope, null at top level
+    ScopeStack scopes;
+    std::unordered_map<size_t, ClassStmt*> classes; // keyed by interned name
+    std::vector<Value> tempRoots; // intermediates held across a nested evaluate()
+    ShadowStack* shadow = nullptr; // set by --profile: lines of the statements being executed
+
+    explicit Interpreter(std::ostream& out = std::cout, std::ostream& err = std::cerr);
+    ~Interpreter();
+    bool interpret(const std::vector<Stmt*>& statements); // false if a runtime error stopped it
     
-    // Visitor methods for evaluating AST
-    Value evaluate(std::shared_ptr<Expr> expr);
-    void execute(std::shared_ptr<Stmt> stmt);
+    // Evaluate/execute switch on the node's kind tag
+    Value evaluate(Expr* expr);
+    void execute(Stmt* stmt);
 
     // Helpers
-    void executeBlock(const std::vector<std::shared_ptr<Stmt>>& statements, Environment* env);
-    void triggerGC();
+    Value evaluateBinary(Binary* expr);
+    void executeBlock(const NodeList<Stmt>& statements, int slotCount);
+    void markRoots() override;
 };
\ No newline at end of file
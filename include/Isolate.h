@@ -0,0 +1,43 @@
+#pragma once
+#include "Runtime.h"
+#include "Stats.h"
+#include <vector>
+
+struct InlineCache;
+struct BinaryFeedback;
+
+// One independent instance of the runtime: a heap with its objects, interned
+// strings and shapes, plus the registries behind --ic-stats and
+// --type-stats and the counters behind --stats. Isolates share nothing, so each thread can run a script in
+// its own at the same time as the others. A thread works in the isolate it
+// has entered; threads that never enter one share the process's default
+// isolate, which is what a single-script run uses.
+class Isolate {
+public:
+    Heap heap;
+    std::vector<InlineCache*> cacheSites;       // registered on their first miss
+    std::vector<BinaryFeedback*> feedbackSites; // registered on their first execution
+    Stats stats;
+
+    Isolate() = default;
+    Isolate(const Isolate&) = delete;
+    Isolate& operator=(const Isolate&) = delete;
+
+    static Isolate& current() { return *active; }
+
+    // Makes an isolate current on this thread until the scope ends. Values
+    // from one isolate must not be used while another is entered.
+    class Scope {
+    public:
+        explicit Scope(Isolate& isolate);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Isolate* previous;
+    };
+
+private:
+    static thread_local Isolate* active;
+};
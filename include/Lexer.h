@@ -1,32 +1,46 @@
 #pragma once
+#include <iostream>
 #include <vector>
-#include <string>
-#include <unordered_map>
+#include <string_view>
 #include "Token.h"
-#include <variant>
+#include "Scanner.h"
 
 class Lexer {
 public:
-    Lexer(std::string source);
+    // The text must outlive the tokens. Kernels default to the fastest the
+    // CPU supports; the benchmarks pass others to compare them.
+    Lexer(std::string_view source, const scan::Kernels& kernels = scan::best());
+
+    // Scans one token; END_OF_FILE (repeatedly) once the text is used up.
+    // The parser pulls tokens this way, so the whole stream never exists.
+    Token next();
+    // The whole stream at once, ending in END_OF_FILE
     std::vector<Token> scanTokens();
 
+    std::ostream* diagnostics = &std::cerr; // where scan errors are reported
+    size_t errors = 0;                      // ... and how many there were
+
 private:
-    std::string source;
-    std::vector<Token> tokens;
+    std::string_view source;
+    const scan::Kernels& kernels;
+    Token scanned;          // set by addToken
+    bool haveToken = false;
     int start = 0;
     int current = 0;
     int line = 1;
-    static std::unordered_map<std::string, TokenType> keywords;
 
     bool isAtEnd();
     char advance();
     void addToken(TokenType type);
-    void addToken(TokenType type, std::variant<std::monostate, double, std::string, bool> literal);
+    void addToken(TokenType type, Value literal);
     char peek();
     char peekNext();
     bool match(char expected);
+    const char* cursor() const { return source.data() + current; }
+    const char* end() const { return source.data() + source.size(); }
+    void moveTo(const char* p) { current = int(p - source.data()); }
     void string();
     void number();
     void identifier();
     void scanToken();
-};
\ No newline at end of file
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include "AST.h"
+#include "Arena.h"
+#include <vector>
+
+// Optional pass run after the Resolver at -O1. Folds operators whose
+// operands are all literals (arithmetic, comparisons, equality, string
+// concatenation) and drops identity operations such as `x * 1`. It never
+// changes what a program prints or whether it fails: an operation that would
+// raise a runtime error is left for the runtime to raise, and an identity is
+// only dropped when the other operand is known to be a number.
+class Optimizer {
+public:
+    explicit Optimizer(Arena& ast) : ast(ast) {}
+    void optimize(std::vector<Stmt*>& statements);
+
+    size_t folded = 0;      // operators replaced by a literal
+    size_t simplified = 0;  // identity operations replaced by their operand
+
+private:
+    Arena& ast; // replacement literals are allocated next to the nodes they replace
+
+    void optimizeStmt(Stmt* stmt);
+    Expr* optimizeExpr(Expr* expr); // returns the replacement, or expr itself
+    Expr* foldBinary(Binary* e);
+    Expr* simplifyBinary(Binary* e);
+};
@@ -1,45 +1,62 @@
 #pragma once
+#include <initializer_list>
 #include <vector>
-#include <memory>
 #include <stdexcept>
-#include "Token.h"
+#include "Lexer.h"
 #include "AST.h"
+#include "Arena.h"
 
 class Parser {
 public:
-    Parser(const std::vector<Token>& tokens) : tokens(tokens) {}
-    std::vector<std::shared_ptr<Stmt>> parse();
+    // Nodes are allocated in `ast`, which must outlive every use of them
+    Parser(Lexer& lexer, Arena& ast) : lexer(lexer), ast(ast) {}
+    std::vector<Stmt*> parse();
+    // One top-level declaration at a time, for callers that do not keep the
+    // whole program; null at the end of the input
+    Stmt* parseNext();
 
 private:
-    std::vector<Token> tokens;
-    int current = 0;
+    // Tokens are pulled from the lexer as the parser reaches them. Token i
+    // lives in ring[i % LOOKAHEAD], so only the previous token, the current
+    // one and anything peeked past it are ever held.
+    static constexpr size_t LOOKAHEAD = 4;
+    Lexer& lexer;
+    Token ring[LOOKAHEAD];
+    size_t current = 0; // tokens consumed so far
+    size_t scanned = 0; // tokens pulled from the lexer so far
+    Arena& ast;
+    std::vector<Stmt*> pending; // statements of the blocks being parsed
 
     // Statement types
-    std::shared_ptr<Stmt> declaration();
-    std::shared_ptr<Stmt> classDeclaration();
-    std::shared_ptr<Stmt> varDeclaration();
-    std::shared_ptr<Stmt> statement();
-    std::shared_ptr<Stmt> printStatement();
-    std::shared_ptr<Stmt> expressionStatement();
+    Stmt* declaration();
+    Stmt* classDeclaration();
+    Stmt* varDeclaration();
+    Stmt* statement();
+    Stmt* printStatement();
+    Stmt* whileStatement();
+    Stmt* expressionStatement();
+    NodeList<Stmt> block();
 
     // Expressions (Ordered by precedence)
-    std::shared_ptr<Expr> expression();
-    std::shared_ptr<Expr> assignment();
-    std::shared_ptr<Expr> equality();
-    std::shared_ptr<Expr> comparison();
-    std::shared_ptr<Expr> term();
-    std::shared_ptr<Expr> factor();
-    std::shared_ptr<Expr> unary();
-    std::shared_ptr<Expr> call();
-    std::shared_ptr<Expr> primary();
+    Expr* expression();
+    Expr* assignment();
+    Expr* equality();
+    Expr* comparison();
+    Expr* term();
+    Expr* factor();
+    Expr* unary();
+    Expr* call();
+    Expr* primary();
 
     // Helpers
-    bool match(std::vector<TokenType> types);
+    Value numberLiteral(const Token& token);
+    Value stringLiteral(const Token& token);
+    bool match(std::initializer_list<TokenType> types);
     bool match(TokenType type);
     bool check(TokenType type);
-    Token advance();
+    const Token& advance();
     bool isAtEnd();
-    Token peek();
-    Token previous();
-    Token consume(TokenType type, std::string message);
+    const Token& peek();
+    const Token& previous();
+    const Token& consume(TokenType type, const char* message);
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Source lines the engine is executing, one per nesting level, outermost
+// first (--profile). Each level holds the line of the statement running at
+// it: a statement stores its line on entry, and a loop runs its body one
+// level down, so a sample inside the body shows the loop's line above the
+// body statement's. The engine updates the stack on its own thread while a
+// Profiler's sampler thread reads it, so the slots and the depth are relaxed
+// atomics: plain loads and stores on the targets we build for.
+class ShadowStack {
+public:
+    static constexpr int MAX_DEPTH = 256; // deeper levels share the last slot
+
+    void enter() {
+        int d = depth.load(std::memory_order_relaxed) + 1;
+        top = &lines[std::min(d, MAX_DEPTH) - 1];
+        depth.store(d, std::memory_order_release);
+    }
+    void leave() {
+        int d = depth.load(std::memory_order_relaxed) - 1;
+        top = &lines[std::clamp(d, 1, MAX_DEPTH) - 1];
+        depth.store(d, std::memory_order_relaxed);
+    }
+
+    // The statement now running at the current level
+    void at(int line) { top->store(line, std::memory_order_relaxed); }
+
+    // After a runtime error unwound past the leaves
+    void clear() {
+        top = &lines[0];
+        depth.store(0, std::memory_order_relaxed);
+    }
+
+    // Copies the current lines into out. Racing with the engine, a snapshot
+    // can pair a level with a line from just before or after; for a sampler
+    // that is noise, not an error.
+    void snapshot(std::vector<int>& out) const;
+
+private:
+    std::atomic<int> lines[MAX_DEPTH] = {};
+    std::atomic<int> depth{0};
+    std::atomic<int>* top = &lines[0]; // only used by the engine's thread
+};
+
+// Sampling profiler behind --profile. Between start() and stop() a sampler
+// thread wakes up hz times a second and counts the stack it finds on the
+// ShadowStack. writeFolded() prints the counts as folded stacks, one
+// "script;script:5;script:7 42" line per distinct stack, the input format
+// of flamegraph.pl, inferno and speedscope.
+class Profiler {
+public:
+    // Not a round number, so samples do not line up with periodic work
+    static constexpr int DEFAULT_HZ = 997;
+
+    Profiler(const ShadowStack& stack, std::string script, int hz = DEFAULT_HZ);
+    ~Profiler();
+
+    void start();
+    void stop();
+
+    uint64_t samples() const { return total; }
+    void writeFolded(std::ostream& out) const;
+
+private:
+    const ShadowStack& stack;
+    std::string script;
+    std::chrono::nanoseconds period;
+    std::thread sampler;
+    std::atomic<bool> running{false};
+    std::map<std::vector<int>, uint64_t> counts; // only touched by the sampler until it is joined
+    uint64_t total = 0;
+
+    void run();
+};
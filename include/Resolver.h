@@ -0,0 +1,25 @@
+#pragma once
+#include "AST.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Static pass run between Parser::parse() and execution. Annotates every
+// Variable/Assign with (depth, slot), every VarStmt with its slot and every
+// Block with its slot count, so lookups at runtime are plain array indexing.
+// Globals get a name-to-index table that is filled once, here.
+class Resolver {
+public:
+    void resolve(const std::vector<Stmt*>& statements);
+    size_t globalCount() const { return globals.size(); }
+
+private:
+    // Keyed by the interned name's heap address
+    std::vector<std::unordered_map<size_t, int>> scopes;
+    std::unordered_map<size_t, int> globals;
+
+    void resolveStmt(Stmt* stmt);
+    void resolveExpr(Expr* expr);
+    void resolveName(Value name, int line, int& depth, int& slot);
+    int declare(Value name);
+};
@@ -1,10 +1,36 @@
 #pragma once
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <variant>
 #include <vector>
 #include <unordered_map>
 #include <memory>
-#include "AST.h"
+#include <string_view>
+#include <new>
+#include <ostream>
+#include "Shape.h"
+#include "Allocator.h"
+#include "GCWorkers.h"
+
+// Value layout switch. The NaN-boxed layout packs every value into 64 bits:
+// doubles are stored as-is, everything else lives in the payload of a quiet
+// NaN. Building with JLITE_NAN_BOXING=0 uses a tagged variant instead. In
+// both layouts strings are references to interned StringObjects.
+#ifndef JLITE_NAN_BOXING
+#define JLITE_NAN_BOXING 1
+#endif
+
+// Counters behind --stats (see Stats.h). Building with JLITE_STATS=0 turns
+// every JLITE_COUNT into nothing, so the hot paths carry no instrumentation.
+#ifndef JLITE_STATS
+#define JLITE_STATS 1
+#endif
+#if JLITE_STATS
+#define JLITE_COUNT(...) ((void)(__VA_ARGS__))
+#else
+#define JLITE_COUNT(...) ((void)0)
+#endif
 
 // Forward Decl
 class Environment;
@@ -12,39 +38,347 @@ class LoxInstance;
 
 // A Value in our language
 struct Value {
-    enum Type { NIL, BOOL, NUMBER, STRING, INSTANCE, FUNCTION } type;
-    std::variant<std::monostate, bool, double, std::string, size_t> as; // size_t is heap address
+    enum Type { NIL, BOOL, NUMBER, STRING, INSTANCE, FUNCTION };
+
+    static Value nil();
+    static Value boolean(bool b);
+    static Value number(double d);
+    static Value string(std::string_view s);  // interned: equal contents share one object
+    static Value instance(size_t addr);
+
+    Type type() const;
+    bool isNil() const { return type() == NIL; }
+    bool isBool() const { return type() == BOOL; }
+    bool isNumber() const;
+    bool isString() const { return type() == STRING; }
+    bool isInstance() const { return type() == INSTANCE; }
+    bool isObject() const;                // string or instance: refers to the heap
+
+    bool asBool() const;
+    double asNumber() const;
+    std::string_view asString() const;
+    size_t asHandle() const;              // heap address of a string or instance
 
     std::string toString() const;
+    bool isTruthy() const;
+    bool operator==(const Value& other) const;
+
+#if JLITE_NAN_BOXING
+    static constexpr uint64_t SIGN_BIT = 0x8000000000000000ull;
+    static constexpr uint64_t QNAN     = 0x7ffc000000000000ull;
+    static constexpr uint64_t TAG_NIL   = 1;
+    static constexpr uint64_t TAG_FALSE = 2;
+    static constexpr uint64_t TAG_TRUE  = 3;
+    // Heap references: SIGN | QNAN | kind << 48 | 48-bit heap address
+    static constexpr uint64_t REF_STRING   = 0ull << 48;
+    static constexpr uint64_t REF_INSTANCE = 1ull << 48;
+    static constexpr uint64_t REF_KIND     = 3ull << 48;
+    static constexpr uint64_t ADDR_MASK    = (1ull << 48) - 1;
+
+    uint64_t bits = QNAN | TAG_NIL;
+#else
+    Type tag = NIL;
+    std::variant<std::monostate, bool, double, size_t> as; // size_t is heap address
+#endif
 };
 
 // Heap Object Base
 struct HeapObject {
+    enum Kind : uint8_t { STRING, INSTANCE };
+    Kind kind;
     bool marked = false;
+    bool pinned = false; // never swept (strings referenced by compiled code)
+    uint8_t sizeClass = 0; // PoolAllocator class the object lives in
+    bool old = false;      // promoted out of the nursery
+    uint8_t age = 0;       // minor collections survived while young
+    bool remembered = false; // old, and in the remembered set
+    HeapObject(Kind kind) : kind(kind) {}
     virtual ~HeapObject() = default;
 };
 
-// A concrete instance of a class
+// An interned string. Only one StringObject exists per distinct contents,
+// so string equality is handle equality. The characters (NUL-terminated)
+// follow the object in the same pool cell.
+struct StringObject : HeapObject {
+    uint32_t hash;
+    uint32_t length;
+    StringObject(uint32_t hash, uint32_t length) : HeapObject(STRING), hash(hash), length(length) {}
+
+    const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+    std::string_view chars() const { return {data(), length}; }
+
+    static uint32_t hashString(std::string_view s);
+};
+
+// A concrete instance of a class. The Shape maps field names (interned heap
+// addresses) to slots; the first few slots are stored inline.
 struct InstanceObject : HeapObject {
-    std::string className;
-    std::unordered_map<std::string, Value> fields;
-    InstanceObject(std::string name) : className(name) {}
+    static constexpr size_t INLINE_SLOTS = 4;
+
+    Shape* shape;
+    Value inlineSlots[INLINE_SLOTS];
+    std::vector<Value> extraSlots;
+
+    InstanceObject(Shape* shape) : HeapObject(INSTANCE), shape(shape) {}
+
+    Value& slot(size_t i) { return i < INLINE_SLOTS ? inlineSlots[i] : extraSlots[i - INLINE_SLOTS]; }
+    bool getField(size_t name, Value& out);          // false if the field was never set
+    void setField(size_t name, const Value& value);  // transitions the shape on a new field
+
+    // Moves to `next` (a transition of the current shape) and stores its new last slot
+    inline void appendSlot(Shape* next, const Value& value);
+};
+
+// Open-addressing set of every live StringObject, keyed by contents.
+// Entries are weak: Heap::sweep removes strings it frees.
+class StringTable {
+public:
+    size_t find(std::string_view chars, uint32_t hash) const; // handle, or 0 if absent
+    void insert(StringObject* str, size_t addr);
+    void remove(StringObject* str);
+    size_t size() const { return count; }
+
+private:
+    struct Entry {
+        StringObject* key = nullptr;  // nullptr with addr != 0 is a tombstone
+        size_t addr = 0;
+    };
+    std::vector<Entry> entries;
+    size_t count = 0;       // live entries
+    size_t used = 0;        // live entries plus tombstones
+
+    void grow();
+};
+
+// Anything holding Values the collector cannot find on its own (an
+// interpreter's environments, the VM's stack) registers itself with the
+// Heap, so any allocation can start a collection.
+class GCRoots {
+public:
+    virtual void markRoots() = 0;
+
+protected:
+    ~GCRoots() = default;
 };
 
 // The Memory Manager
+//
+// Heap addresses are handles into a contiguous slot table: the low 32 bits
+// are the slot index and the next 16 bits the slot's generation. Freeing an
+// object bumps its slot's generation and puts the slot on a free list, so a
+// stale handle is caught by one compare on access.
+//
+// Objects are born young. The nursery is the list of young handles; once it
+// holds more than nurserySize bytes a minor collection marks only young
+// objects (from the roots and the remembered set of old objects that point
+// into the nursery) and sweeps only the nursery. Survivors are promoted
+// after promotionAge minor collections. Nothing moves, so "old space" is
+// just the set of objects with `old` set. A full collection marks and sweeps
+// everything and promotes every survivor; given a pause budget it runs
+// incrementally, in slices interleaved with allocation (see Runtime.cpp).
+//
+// Each isolate (see Isolate.h) has its own Heap: handles, interned strings
+// and shapes mean nothing outside it. Code reaches the heap of the isolate
+// its thread has entered through Heap::current().
 class Heap {
 public:
-    static std::unordered_map<size_t, HeapObject*> objects;
-    static size_t nextId;
-    static size_t bytesAllocated;
-    static size_t nextGC;
-
-    static size_t allocate(HeapObject* obj);
-    static HeapObject* get(size_t addr);
-    
+    struct Slot {
+        HeapObject* object;
+        uint16_t generation;
+        uint32_t nextFree;    // next slot on the free list (0 ends it)
+    };
+
+    std::vector<Slot> slots = {{nullptr, 0xFFFF, 0}}; // slot 0 never matches, so no handle is 0
+    uint32_t freeList = 0;
+    size_t objectCount = 0;        // live objects
+    size_t bytesAllocated = 0;     // pool cells plus out-of-line field storage
+    size_t nextGC = 1024 * 1024;   // collect once bytesAllocated would pass this
+    double growthFactor = 2.0;     // after a GC, nextGC = live bytes * growthFactor
+    size_t minHeap = 1024 * 1024;  // ... but never below this
+    size_t collections = 0;        // full collections
+    int noGC = 0;                  // > 0 while a NoGC scope is active
+
+    size_t nurserySize = 256 * 1024; // minor GC threshold in young bytes (0 = not generational)
+    uint8_t promotionAge = 2;
+    size_t youngBytes = 0;
+    size_t minorCollections = 0;
+    double lastPauseMs = 0;        // duration of the most recent pause (minor, slice or full)
+    size_t pauseCount = 0;
+    double totalPauseMs = 0;       // the rest are only kept with JLITE_STATS
+    double maxPauseMs = 0;
+    size_t allocations = 0;        // objects ever allocated, strings included
+    size_t objectsFreed = 0;
+
+    // Incremental full collections
+    enum Phase : uint8_t { IDLE, MARKING, SWEEPING };
+    static constexpr size_t SLICE_BYTES = 64 * 1024; // allocation between two slices
+    static constexpr size_t LAZY_SWEEP_SLOTS = 32 * 1024; // per slice and GC worker when there is no budget
+    static constexpr size_t PARALLEL_SWEEP_MIN = 64 * 1024; // smaller ranges are swept on one thread
+    static_assert(2 * LAZY_SWEEP_SLOTS >= PARALLEL_SWEEP_MIN, "a lazy slice with two workers must sweep in parallel");
+    Phase phase = IDLE;
+    size_t pauseBudgetUs = 1000;   // per slice; 0 = mark stop-the-world, then sweep lazily
+    GCWorkerPool workers;          // parallel marking and sweeping (size 1 = serial)
+    bool traceGC = false;          // --gc-trace: print every pause
+
+    StringTable strings;
+    PoolAllocator allocator;
+    bool traceStats = false;       // --heap-stats: report pages and fragmentation after each sweep
+
+    Heap() = default;
+    Heap(const Heap&) = delete;
+    Heap& operator=(const Heap&) = delete;
+    ~Heap();                       // frees every object and shape
+
+    // The heap of the isolate this thread has entered
+    static Heap& current() { return *active; }
+
+    // Keeps allocation from collecting, for code that holds unrooted Values
+    struct NoGC {
+        Heap& heap;
+        NoGC() : heap(current()) { heap.noGC++; }
+        ~NoGC() { heap.noGC--; }
+    };
+
+    // Constructs a T in pool memory and gives it a handle. May collect first.
+    template <typename T, typename... Args>
+    size_t allocate(Args&&... args) {
+        maybeCollect(sizeof(T));
+        uint8_t sizeClass;
+        void* mem = allocator.allocate(sizeof(T), sizeClass);
+        T* obj = new (mem) T(std::forward<Args>(args)...);
+        obj->sizeClass = sizeClass;
+        bytesAllocated += PoolAllocator::blockSize(mem, sizeClass);
+        return track(obj);
+    }
+    void maybeCollect(size_t bytes) {
+        if (noGC) return;
+        if (phase != IDLE) {
+            if (bytesAllocated >= nextSlice) step();
+        } else if (bytesAllocated + bytes > nextGC) {
+            startCollection();
+        } else if (nurserySize && youngBytes + bytes > nurserySize) {
+            collectYoung();
+        }
+    }
+    static size_t sizeOf(const HeapObject* obj);
+    HeapObject* get(size_t addr);
+    static uint32_t slotIndex(size_t addr) { return uint32_t(addr); }
+    size_t intern(std::string_view chars);
+    void pin(const Value& val);
+    Shape* rootShape(size_t className); // the empty shape of a class
+
     // Garbage Collection
-    static void collectGarbage(Environment* roots);
-    static void mark(Value val);
-    static void markObject(HeapObject* obj);
-    static void sweep();
-};
\ No newline at end of file
+    void addRoots(GCRoots* source);
+    void removeRoots(GCRoots* source);
+    void collectGarbage();    // full and stop-the-world (finishes a running cycle)
+    void collectYoung();
+    void writeBarrier(HeapObject* obj, const Value& value);
+    void mark(const Value& val);
+    void markObject(HeapObject* obj);
+    void traceReferences();   // blackens gray objects until none are left
+    void sweep();             // frees everything unmarked and promotes the rest
+
+    void dumpStats(std::ostream& out);
+    void dumpPauses(std::ostream& out);
+
+private:
+    friend class Isolate;
+    static thread_local Heap* active;
+
+    std::vector<GCRoots*> roots;
+    std::vector<HeapObject*> grayStack; // marked instances whose fields are not traced yet
+    std::vector<size_t> nursery;         // handles of young objects
+    std::vector<HeapObject*> rememberedSet;
+    bool minorGC = false;                // marking stops at old objects
+    size_t nextSlice = 0;                // bytesAllocated at which the next slice runs
+    uint32_t sweepCursor = 0;            // slots below this are swept this cycle
+    std::vector<double> pauseLog;        // every pause in ms, kept under --gc-trace
+    std::unordered_map<size_t, Shape*> shapes; // root shape per class name
+
+    size_t track(HeapObject* obj);
+    void freeSlot(uint32_t index);
+    void release(HeapObject* obj);
+    void blacken(HeapObject* obj);
+    void sweepSlot(uint32_t index);
+    void sweepRange(uint32_t from, uint32_t to);
+    void traceParallel();
+    void finishSweep();
+    void sweepYoung();
+    void forgetRemembered();
+    void barrierSlow(HeapObject* obj, const Value& value);
+    bool pointsIntoNursery(HeapObject* obj);
+
+    void startCollection();
+    void startCycle();
+    void step();
+    void remark();
+    void finishCycle();
+    void recordPause(const char* what, double ms);
+    [[noreturn]] static void freedAccess();
+};
+
+inline void InstanceObject::appendSlot(Shape* next, const Value& value) {
+    shape = next;
+    if (next->slotCount() > INLINE_SLOTS) {
+        size_t capacity = extraSlots.capacity();
+        extraSlots.push_back(value);
+        Heap::current().bytesAllocated += (extraSlots.capacity() - capacity) * sizeof(Value);
+    } else {
+        inlineSlots[next->slotCount() - 1] = value;
+    }
+}
+
+// Write barrier, run on every field store. An old object that starts
+// pointing at a young one has to be traced by minor collections, and while
+// a cycle is marking, a marked object must not hide a white one.
+inline void Heap::writeBarrier(HeapObject* obj, const Value& value) {
+    if (value.isObject() && ((obj->old && !obj->remembered) || phase == MARKING)) barrierSlow(obj, value);
+}
+
+inline HeapObject* Heap::get(size_t addr) {
+    uint32_t index = slotIndex(addr);
+    if (index < slots.size() && slots[index].generation == uint16_t(addr >> 32)) return slots[index].object;
+    freedAccess();
+}
+
+// --- Value accessors (hot, so inline) ---
+#if JLITE_NAN_BOXING
+
+inline Value Value::nil() { return Value(); }
+inline Value Value::boolean(bool b) { Value v; v.bits = QNAN | (b ? TAG_TRUE : TAG_FALSE); return v; }
+inline Value Value::number(double d) { Value v; std::memcpy(&v.bits, &d, sizeof d); return v; }
+inline Value Value::instance(size_t addr) { Value v; v.bits = SIGN_BIT | QNAN | REF_INSTANCE | addr; return v; }
+
+inline bool Value::isNumber() const { return (bits & QNAN) != QNAN; }
+inline bool Value::isObject() const { return (bits & (SIGN_BIT | QNAN)) == (SIGN_BIT | QNAN); }
+
+inline Value::Type Value::type() const {
+    if (isNumber()) return NUMBER;
+    if (bits & SIGN_BIT) return (bits & REF_KIND) == REF_STRING ? STRING : INSTANCE;
+    return bits == (QNAN | TAG_NIL) ? NIL : BOOL;
+}
+
+inline bool Value::asBool() const { return bits == (QNAN | TAG_TRUE); }
+inline double Value::asNumber() const { double d; std::memcpy(&d, &bits, sizeof d); return d; }
+inline size_t Value::asHandle() const { return bits & ADDR_MASK; }
+
+#else
+
+inline Value Value::nil() { return Value(); }
+inline Value Value::boolean(bool b) { Value v; v.tag = BOOL; v.as = b; return v; }
+inline Value Value::number(double d) { Value v; v.tag = NUMBER; v.as = d; return v; }
+inline Value Value::instance(size_t addr) { Value v; v.tag = INSTANCE; v.as = addr; return v; }
+
+inline bool Value::isNumber() const { return tag == NUMBER; }
+inline bool Value::isObject() const { return tag == STRING || tag == INSTANCE; }
+inline Value::Type Value::type() const { return tag; }
+
+inline bool Value::asBool() const { return std::get<bool>(as); }
+inline double Value::asNumber() const { return std::get<double>(as); }
+inline size_t Value::asHandle() const { return std::get<size_t>(as); }
+
+#endif
+
+inline std::string_view Value::asString() const {
+    return static_cast<StringObject*>(Heap::current().get(asHandle()))->chars();
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include "Scanner.h"
+#include <cstdint>
+
+namespace scan {
+const Kernels* avx2Kernels(); // ScannerAvx2.cpp; null unless built for x86 with AVX2
+}
+
+// Shared bodies of the scan kernels, instantiated once per instruction set.
+// Only the scanner translation units include this. Everything is internal
+// to each of them, so an AVX2 copy of a helper can never be linked into the
+// code that runs on CPUs without AVX2.
+namespace {
+
+const char* scalarWhitespace(const char* p, const char* end, int& lines) {
+    for (; p < end; p++) {
+        if (*p == '\n') lines++;
+        else if (*p != ' ' && *p != '\t' && *p != '\r') break;
+    }
+    return p;
+}
+
+const char* scalarLineEnd(const char* p, const char* end) {
+    while (p < end && *p != '\n') p++;
+    return p;
+}
+
+const char* scalarStringEnd(const char* p, const char* end, int& lines) {
+    for (; p < end && *p != '"'; p++) {
+        if (*p == '\n') lines++;
+    }
+    return p;
+}
+
+const char* scalarIdentifier(const char* p, const char* end) {
+    while (p < end && scan::isAlnum(*p)) p++;
+    return p;
+}
+
+const char* scalarDigits(const char* p, const char* end) {
+    while (p < end && scan::isDigit(*p)) p++;
+    return p;
+}
+
+// Newlines are rare inside a run, so clearing bits one at a time beats a
+// popcount, which without -mpopcnt is a library call
+inline int countBits(uint32_t mask) {
+    int n = 0;
+    for (; mask; mask &= mask - 1) n++;
+    return n;
+}
+
+// S supplies a vector register type of S::WIDTH bytes and the handful of
+// byte-wise operations below; mask() packs one bit per byte, lowest byte
+// first. Each loop handles whole vectors and leaves the tail to the scalar
+// version.
+template <class S>
+struct SimdKernels {
+    using Vec = typename S::Vec;
+
+    // Bytes within [lo, hi]; the signed compares reject bytes >= 0x80
+    static Vec inRange(Vec v, char lo, char hi) {
+        return S::bitAnd(S::greater(v, S::splat(char(lo - 1))), S::greater(S::splat(char(hi + 1)), v));
+    }
+
+    static const char* whitespace(const char* p, const char* end, int& lines) {
+        for (; end - p >= S::WIDTH; p += S::WIDTH) {
+            Vec v = S::load(p);
+            uint32_t newlines = S::mask(S::equal(v, S::splat('\n')));
+            uint32_t blanks = S::mask(S::bitOr(S::bitOr(S::equal(v, S::splat(' ')), S::equal(v, S::splat('\t'))),
+                                               S::equal(v, S::splat('\r'))));
+            uint32_t stop = ~(newlines | blanks) & S::ALL;
+            if (stop) {
+                int at = __builtin_ctz(stop);
+                lines += countBits(newlines & ((1u << at) - 1));
+                return p + at;
+            }
+            lines += countBits(newlines);
+        }
+        return scalarWhitespace(p, end, lines);
+    }
+
+    static const char* lineEnd(const char* p, const char* end) {
+        for (; end - p >= S::WIDTH; p += S::WIDTH) {
+            uint32_t stop = S::mask(S::equal(S::load(p), S::splat('\n')));
+            if (stop) return p + __builtin_ctz(stop);
+        }
+        return scalarLineEnd(p, end);
+    }
+
+    static const char* stringEnd(const char* p, const char* end, int& lines) {
+        for (; end - p >= S::WIDTH; p += S::WIDTH) {
+            Vec v = S::load(p);
+            uint32_t newlines = S::mask(S::equal(v, S::splat('\n')));
+            uint32_t stop = S::mask(S::equal(v, S::splat('"')));
+            if (stop) {
+                int at = __builtin_ctz(stop);
+                lines += countBits(newlines & ((1u << at) - 1));
+                return p + at;
+            }
+            lines += countBits(newlines);
+        }
+        return scalarStringEnd(p, end, lines);
+    }
+
+    static const char* identifier(const char* p, const char* end) {
+        for (; end - p >= S::WIDTH; p += S::WIDTH) {
+            Vec v = S::load(p);
+            Vec letters = inRange(S::bitOr(v, S::splat(0x20)), 'a', 'z');
+            Vec word = S::bitOr(S::bitOr(letters, inRange(v, '0', '9')), S::equal(v, S::splat('_')));
+            uint32_t stop = ~S::mask(word) & S::ALL;
+            if (stop) return p + __builtin_ctz(stop);
+        }
+        return scalarIdentifier(p, end);
+    }
+
+    static const char* digits(const char* p, const char* end) {
+        for (; end - p >= S::WIDTH; p += S::WIDTH) {
+            uint32_t stop = ~S::mask(inRange(S::load(p), '0', '9')) & S::ALL;
+            if (stop) return p + __builtin_ctz(stop);
+        }
+        return scalarDigits(p, end);
+    }
+
+    static scan::Kernels table(const char* name) {
+        return {name, whitespace, lineEnd, stringEnd, identifier, digits};
+    }
+};
+
+} // namespace
@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+
+// Character-run scans behind the Lexer's fast paths. Each scan starts at p,
+// stops at the first byte that ends the run (or at end) and returns it. The
+// scans that can cross lines add the newlines they pass to `lines`.
+//
+// There are scalar, SSE2 and AVX2 versions; scan::best() picks the widest
+// one the CPU supports, once, at startup.
+namespace scan {
+
+struct Kernels {
+    const char* name;
+    const char* (*whitespace)(const char* p, const char* end, int& lines); // spaces, tabs, CRs, newlines
+    const char* (*lineEnd)(const char* p, const char* end);                // next '\n' (end of a // comment)
+    const char* (*stringEnd)(const char* p, const char* end, int& lines);  // next '"'
+    const char* (*identifier)(const char* p, const char* end);             // [A-Za-z0-9_]*
+    const char* (*digits)(const char* p, const char* end);                 // [0-9]*
+};
+
+const Kernels& best();
+std::vector<const Kernels*> available(); // scalar first, then each SIMD version the CPU supports
+
+// ASCII only: bytes >= 0x80 are never part of a name or number
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool isAlpha(char c) { return ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c == '_'; }
+inline bool isAlnum(char c) { return isAlpha(c) || isDigit(c); }
+
+} // namespace scan
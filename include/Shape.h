@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Hidden class describing the field layout of an InstanceObject. Instances
+// of a class that gain the same fields in the same order share one Shape,
+// which maps each field name (interned heap address) to a slot index.
+// Shapes form a transition tree rooted at one empty shape per class, owned
+// by the heap whose class names key it, and live as long as that heap.
+struct Shape {
+    Shape* parent;
+    size_t className;           // interned class name
+    std::vector<size_t> names;  // field names in slot order
+
+    Shape(Shape* parent, size_t className) : parent(parent), className(className) { shapeCount++; }
+    Shape(const Shape&) = delete;
+    Shape& operator=(const Shape&) = delete;
+    ~Shape();  // frees the subtree of transitions
+
+    size_t slotCount() const { return names.size(); }
+    int lookup(size_t name) const;     // slot, or -1 if absent
+    Shape* addField(size_t name);      // shape with `name` appended (cached transition)
+
+    static Shape* root(size_t className);   // in the current heap
+    static size_t count() { return shapeCount; } // live shapes in all heaps
+
+private:
+    std::unordered_map<size_t, Shape*> transitions;
+    std::unordered_map<size_t, int> index;  // only built for wide shapes
+
+    static constexpr size_t LINEAR_LOOKUP_MAX = 8;
+    static std::atomic<size_t> shapeCount;
+};
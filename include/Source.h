@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+// The text of a script. A file is memory-mapped read-only; stdin ("-") and
+// files that cannot be mapped are read into an owned string instead. Token
+// lexemes point into this buffer, so it must outlive the tokens and the AST.
+class SourceBuffer {
+public:
+    explicit SourceBuffer(const std::string& path); // throws std::runtime_error if unreadable
+    ~SourceBuffer();
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    std::string_view text() const { return mapped ? std::string_view(mapped, mappedSize) : std::string_view(owned); }
+
+private:
+    const char* mapped = nullptr;
+    size_t mappedSize = 0;
+    std::string owned;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include "AST.h"
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+// Per-phase timings and hot-path counters for --stats, one set per isolate.
+// Node counts come from the tree-walker, instruction counts from the VM;
+// environment counts cover both tree-walking engines. The heap keeps its
+// own allocation and GC totals. With JLITE_STATS=0 nothing is counted or
+// timed (see JLITE_COUNT in Runtime.h).
+struct Stats {
+    enum Phase : uint8_t { CACHE, PARSE, RESOLVE, OPTIMIZE, COMPILE, EXECUTE, PHASE_COUNT };
+    static constexpr size_t EXPR_KINDS = size_t(ExprKind::CALL) + 1;
+    static constexpr size_t STMT_KINDS = size_t(StmtKind::CLASS) + 1;
+
+    double phaseMs[PHASE_COUNT] = {};
+    uint64_t exprs[EXPR_KINDS] = {};  // expressions evaluated, by kind
+    uint64_t stmts[STMT_KINDS] = {};  // statements executed, by kind
+    uint64_t instructions[256] = {};  // VM instructions executed, by opcode
+    uint64_t envLookups = 0;          // block-scope variable reads and writes
+    uint64_t envHops = 0;             // enclosing links walked to reach them
+
+    // Adds the time until the end of the scope to a phase (monotonic clock)
+    class Timer {
+    public:
+#if JLITE_STATS
+        Timer(Stats& stats, Phase phase) : stats(stats), phase(phase), start(std::chrono::steady_clock::now()) {}
+        ~Timer() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            stats.phaseMs[phase] += std::chrono::duration<double, std::milli>(elapsed).count();
+        }
+
+    private:
+        Stats& stats;
+        Phase phase;
+        std::chrono::steady_clock::time_point start;
+#else
+        Timer(Stats&, Phase) {}
+#endif
+    };
+
+    // Phases, counters and the heap's totals, as aligned text or one JSON object
+    void dump(std::ostream& out, const Heap& heap, bool json) const;
+};
@@ -1,6 +1,6 @@
 #pragma once
-#include <string>
-#include <variant>
+#include <string_view>
+#include "Runtime.h"
 
 enum TokenType {
     // Single-char
@@ -23,14 +23,15 @@ enum TokenType {
     END_OF_FILE
 };
 
+// The lexeme is a view into the SourceBuffer. NUMBER and STRING values are
+// decoded by the parser when it builds the Literal, not by the lexer.
 struct Token {
     TokenType type;
-    std::string lexeme;
-    std::variant<std::monostate, double, std::string, bool> literal;
+    std::string_view lexeme;
+    Value literal; // for IDENTIFIER, the interned name
     int line;
 
-    Token(TokenType type, std::string lexeme, 
-          std::variant<std::monostate, double, std::string, bool> literal, 
-          int line)
+    Token() : type(END_OF_FILE), literal(Value::nil()), line(0) {}
+    Token(TokenType type, std::string_view lexeme, Value literal, int line)
         : type(type), lexeme(lexeme), literal(literal), line(line) {}
 };
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include "Token.h"
+#include <cstdint>
+#include <iosfwd>
+
+// Per-site operand type feedback for arithmetic and comparison operators.
+// The first execution records the operand types and specializes the site
+// for them; a specialized site checks a guard on every execution and, the
+// first time it fails, deoptimizes to the generic path for good.
+struct BinaryFeedback {
+    enum State : uint8_t { UNINITIALIZED, NUMBER, STRING, GENERIC };
+
+    State state;
+    TokenType op;
+    int line;
+    uint64_t hits = 0;    // executions through the specialized path
+    uint64_t deopts = 0;
+
+    // Sites of operators without a specialized form start out generic
+    BinaryFeedback(TokenType op, int line) : state(quickens(op) ? UNINITIALIZED : GENERIC), op(op), line(line) {}
+
+    // Only +, -, *, / and the relational operators have a specialized form
+    static bool quickens(TokenType op) {
+        return op == PLUS || op == MINUS || op == STAR || op == SLASH || op == GREATER || op == GREATER_EQUAL ||
+               op == LESS || op == LESS_EQUAL;
+    }
+
+    // Picks the specialization for the operands of the first execution
+    State specialize(const Value& left, const Value& right) {
+        if (left.isNumber() && right.isNumber()) return enter(NUMBER);
+        if (op == PLUS && left.isString() && right.isString()) return enter(STRING);
+        return enter(GENERIC);
+    }
+
+    void deoptimize() {
+        deopts++;
+        state = GENERIC;
+    }
+
+    // Prints every site that has executed, ordered by source line
+    static void dumpStats(std::ostream& out);
+
+private:
+    State enter(State next);
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include "Chunk.h"
+#include "Stats.h"
+#include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+
+// Stack-based virtual machine that executes a compiled Chunk.
+class VM : public GCRoots {
+public:
+    explicit VM(std::ostream& out = std::cout, std::ostream& err = std::cerr);
+    ~VM();
+    bool interpret(Chunk& chunk); // false if a runtime error stopped it
+
+private:
+    Heap& heap;        // of the isolate the VM was created in
+    Stats& stats;      // ... and its counters
+    std::ostream& out; // print statements
+    std::ostream& err; // runtime errors
+    Chunk* chunk = nullptr;
+    const uint8_t* ip = nullptr;
+    std::vector<Value> stack;
+    std::vector<Value> globals;   // indexed by the Resolver's global slots
+    std::unordered_set<size_t> classes;  // interned class names
+
+    void run();
+    void markRoots() override;
+    void observe();
+    void deoptimize(uint8_t generic);
+
+    void push(Value value) { stack.push_back(std::move(value)); }
+    Value pop() {
+        Value v = std::move(stack.back());
+        stack.pop_back();
+        return v;
+    }
+    Value& peek(size_t distance = 0) { return stack[stack.size() - 1 - distance]; }
+
+    size_t readIndex();
+    size_t readSlot();
+    const Value& readConstant();
+    int currentLine() const;
+};
@@ -1,39 +1,266 @@
+#include "Source.h"
 #include "Lexer.h"
 #include "Parser.h"
+#include "Resolver.h"
+#include "Optimizer.h"
 #include "Interpreter.h"
-#include <iostream>
+#include "ClosureCompiler.h"
+#include "Compiler.h"
+#include "VM.h"
+#include "CodeCache.h"
+#include "InlineCache.h"
+#include "TypeFeedback.h"
+#include "Batch.h"
+#include "Isolate.h"
+#include "Stats.h"
+#include "Profiler.h"
 #include <fstream>
-#include <sstream>
+#include <iostream>
 #include <string>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+
+// Byte counts accept a K/M/G suffix: "512K", "4M"
+static size_t parseBytes(const std::string& text) {
+    size_t end = 0;
+    double n = std::stod(text, &end);
+    switch (end < text.size() ? std::toupper((unsigned char)text[end]) : 0) {
+        case 'K': n *= 1024; break;
+        case 'M': n *= 1024 * 1024; break;
+        case 'G': n *= 1024.0 * 1024 * 1024; break;
+    }
+    return size_t(n);
+}
+
+// GC tuning. The JLITE_GC_* environment variables set the defaults;
+// the matching --gc-* flags override them.
+struct GCSettings {
+    const char* growth = std::getenv("JLITE_GC_GROWTH");
+    const char* minHeap = std::getenv("JLITE_GC_MIN_HEAP");
+    const char* nursery = std::getenv("JLITE_GC_NURSERY");
+    const char* budget = std::getenv("JLITE_GC_BUDGET");
+    const char* threads = std::getenv("JLITE_GC_THREADS");
+
+    // Parallel marking defaults to one GC thread per core, up to four. A
+    // batch already keeps the cores busy with scripts, so there it defaults
+    // to marking on the script's own thread.
+    void apply(Heap& heap, bool batch = false) const {
+        if (growth) {
+            heap.growthFactor = std::stod(growth);
+            if (heap.growthFactor < 1.0) throw std::invalid_argument("GC growth factor must be at least 1");
+        }
+        if (minHeap) heap.minHeap = parseBytes(minHeap);
+        if (nursery) heap.nurserySize = parseBytes(nursery);
+        if (budget) heap.pauseBudgetUs = std::stoul(budget);
+        size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        heap.workers.resize(threads ? std::stoul(threads) : batch ? 1 : std::min<size_t>(4, cores));
+        heap.nextGC = heap.minHeap;
+    }
+};
+
+// Writes the folded stacks of a stopped profiler
+static bool writeProfile(const Profiler& profiler, const std::string& path) {
+    std::ofstream out(path);
+    profiler.writeFolded(out);
+    if (out) return true;
+    std::cerr << "Error: cannot write profile " << path << "\n";
+    return false;
+}
 
 int main(int argc, char* argv[]) {
 
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>\n";
+    std::string engine = "vm";
+    bool engineSet = false;
+    bool dumpBytecode = false;
+    bool printAst = false;
+    int optLevel = 0;
+    bool icStats = false;
+    bool typeStats = false;
+    bool heapStats = false;
+    bool gcTrace = false;
+    bool useCache = true;
+    std::string statsFormat;  // "text" or "json" with --stats
+    std::string profilePath;  // folded stacks with --profile
+    int profileHz = Profiler::DEFAULT_HZ;
+    GCSettings gc;
+    std::string filename;
+    std::string batchDir;
+    size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--engine=", 0) == 0) {
+            engine = arg.substr(9);
+            engineSet = true;
+        }
+        else if (arg == "--dump-bytecode") dumpBytecode = true;
+        else if (arg == "--dump-ast") printAst = true;
+        else if (arg == "-O0") optLevel = 0;
+        else if (arg == "-O1") optLevel = 1;
+        else if (arg == "--ic-stats") icStats = true;
+        else if (arg == "--type-stats") typeStats = true;
+        else if (arg == "--heap-stats") heapStats = true;
+        else if (arg == "--gc-trace") gcTrace = true;
+        else if (arg == "--no-cache") useCache = false;
+        else if (arg == "--stats") statsFormat = "text";
+        else if (arg == "--stats=json") statsFormat = "json";
+        else if (arg == "--profile") profilePath = "jlite.folded";
+        else if (arg.rfind("--profile=", 0) == 0) profilePath = arg.substr(10);
+        else if (arg.rfind("--profile-hz=", 0) == 0) profileHz = std::atoi(argv[i] + 13);
+        else if (arg.rfind("--gc-growth=", 0) == 0) gc.growth = argv[i] + 12;
+        else if (arg.rfind("--gc-min-heap=", 0) == 0) gc.minHeap = argv[i] + 14;
+        else if (arg.rfind("--gc-nursery=", 0) == 0) gc.nursery = argv[i] + 13;
+        else if (arg.rfind("--gc-budget=", 0) == 0) gc.budget = argv[i] + 12;
+        else if (arg.rfind("--gc-threads=", 0) == 0) gc.threads = argv[i] + 13;
+        else if (arg == "--batch" && i + 1 < argc) batchDir = argv[++i];
+        else if (arg == "-j" && i + 1 < argc) jobs = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg.rfind("-j", 0) == 0 && arg.size() > 2) jobs = std::strtoul(argv[i] + 2, nullptr, 10);
+        else filename = arg;
+    }
+
+    bool profile = !profilePath.empty();
+    if ((filename.empty() == batchDir.empty()) || jobs == 0 || (engine != "vm" && engine != "ast" && engine != "closure") ||
+        (profile && (!batchDir.empty() || profileHz <= 0))) {
+        std::cerr << "Usage: " << argv[0] << " [--engine=vm|ast|closure] [-O0|-O1] [--dump-ast] [--dump-bytecode] [--ic-stats] [--type-stats] [--heap-stats] [--gc-growth=F] [--gc-min-heap=BYTES] [--gc-nursery=BYTES] [--gc-budget=US] [--gc-threads=N] [--gc-trace] [--no-cache] [--stats[=json]] [--profile[=FILE]] [--profile-hz=N] <filename | ->\n"
+                  << "       " << argv[0] << " [--engine=vm|ast|closure] [-O0|-O1] [--gc-*=...] [--no-cache] --batch <directory> [-j N]\n";
         return 1;
     }
 
-    std::string filename = argv[1];
-    std::ifstream file(filename, std::ios::in | std::ios::binary);
+    // The shadow stack is kept by the tree-walking engines; the VM has no
+    // statement nesting to keep one from. Profiling runs on the closure
+    // engine unless another was asked for.
+    if (profile && engine == "vm") {
+        if (engineSet) {
+            std::cerr << "Error: --profile needs --engine=closure or --engine=ast\n";
+            return 1;
+        }
+        engine = "closure";
+    }
 
-    if (!file) {  // check if file opened successfully
-        std::cerr << "Error: Could not open file " << filename << "\n";
+    try {
+        gc.apply(Heap::current());
+    } catch (std::exception&) {
+        std::cerr << "Error: invalid GC setting (growth must be a number >= 1, sizes byte counts, budget microseconds, threads a count)\n";
         return 1;
     }
-    std::ostringstream buffer;
-    buffer << file.rdbuf();
-    std::string fileContents = buffer.str();
 
-    std::string code = fileContents;
-    
-    Lexer lexer(code);
-    std::vector<Token> tokens = lexer.scanTokens();
+    if (!batchDir.empty()) {
+        BatchOptions options;
+        options.engine = engine;
+        options.optLevel = optLevel;
+        options.jobs = jobs;
+        options.cacheDirectory = useCache ? CodeCache::defaultDirectory() : "";
+        options.configureHeap = [&gc](Heap& heap) { gc.apply(heap, true); };
+        try {
+            BatchResult result = runBatch(listScripts(batchDir), options, std::cout, std::cerr);
+            return result.failed ? 1 : 0;
+        } catch (std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
 
-    Parser parser(tokens);
-    std::vector<std::shared_ptr<Stmt>> statements = parser.parse();
+    // Mapped, not copied; tokens and the AST point into it until exit
+    std::unique_ptr<SourceBuffer> source;
+    try {
+        source = std::make_unique<SourceBuffer>(filename);
+    } catch (std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    Heap& heap = Heap::current();
+    heap.traceStats = heapStats;
+    heap.traceGC = gcTrace;
+
+    Stats& stats = Isolate::current().stats;
+    auto report = [&] {
+        if (icStats) InlineCache::dumpStats(std::cerr);
+        if (typeStats) BinaryFeedback::dumpStats(std::cerr);
+        if (gcTrace) heap.dumpPauses(std::cerr);
+        if (!statsFormat.empty()) stats.dump(std::cerr, heap, statsFormat == "json");
+    };
+
+    // The VM can start from a cached chunk and skip the front end entirely;
+    // the other engines and --dump-ast need the syntax tree
+    CodeCache cache(useCache && engine == "vm" ? CodeCache::defaultDirectory() : "");
+    Chunk chunk;
+    bool cached = false;
+    if (!printAst) {
+        Stats::Timer timer(stats, Stats::CACHE);
+        cached = cache.load(source->text(), optLevel, chunk);
+    }
+    if (!cached) {
+        Lexer lexer(source->text());
+        Arena ast;
+        Parser parser(lexer, ast);
+        std::vector<Stmt*> statements;
+        {
+            Stats::Timer timer(stats, Stats::PARSE); // lexing included: the parser pulls tokens
+            statements = parser.parse();
+        }
 
-    Interpreter interpreter;
-    interpreter.interpret(statements);
+        try {
+            Stats::Timer timer(stats, Stats::RESOLVE);
+            Resolver resolver;
+            resolver.resolve(statements);
+        } catch (std::runtime_error& e) {
+            std::cerr << "Resolve Error: " << e.what() << "\n";
+            return 1;
+        }
+
+        if (optLevel >= 1) {
+            Stats::Timer timer(stats, Stats::OPTIMIZE);
+            Optimizer optimizer(ast);
+            optimizer.optimize(statements);
+        }
+        if (printAst) dumpAst(statements, filename);
+
+        if (engine != "vm") {
+            Interpreter interpreter;
+            ShadowStack shadow;
+            Profiler profiler(shadow, filename == "-" ? "stdin" : filename, profileHz);
+            if (profile) interpreter.shadow = &shadow;
+            if (engine == "closure") {
+                std::vector<StmtClosure*> program;
+                {
+                    Stats::Timer timer(stats, Stats::COMPILE);
+                    program = ClosureCompiler(ast, profile).link(statements);
+                }
+                Stats::Timer timer(stats, Stats::EXECUTE);
+                if (profile) profiler.start();
+                ClosureCompiler::run(interpreter, program);
+            } else {
+                Stats::Timer timer(stats, Stats::EXECUTE);
+                if (profile) profiler.start();
+                interpreter.interpret(statements);
+            }
+            profiler.stop();
+            report();
+            return !profile || writeProfile(profiler, profilePath) ? 0 : 1;
+        }
+
+        {
+            Stats::Timer timer(stats, Stats::COMPILE);
+            Compiler compiler;
+            chunk = compiler.compile(statements);
+        }
+        Stats::Timer timer(stats, Stats::CACHE);
+        // A cache hit skips the lexer, so a script with scan errors is not
+        // cached: every run reports them
+        if (lexer.errors == 0) cache.store(source->text(), optLevel, chunk);
+    }
+    if (dumpBytecode) chunk.disassemble(filename);
+
+    VM vm;
+    {
+        Stats::Timer timer(stats, Stats::EXECUTE);
+        vm.interpret(chunk);
+    }
+    report();
 
     return 0;
-}
\ No newline at end of file
+}
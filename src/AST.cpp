@@ -0,0 +1,108 @@
+#include "AST.h"
+#include <cstdio>
+#include <string>
+
+static const char* opText(TokenType op) {
+    switch (op) {
+        case PLUS: return "+";
+        case MINUS: return "-";
+        case STAR: return "*";
+        case SLASH: return "/";
+        case BANG: return "!";
+        case EQUAL_EQUAL: return "==";
+        case BANG_EQUAL: return "!=";
+        case GREATER: return ">";
+        case GREATER_EQUAL: return ">=";
+        case LESS: return "<";
+        case LESS_EQUAL: return "<=";
+        default: return "?";
+    }
+}
+
+static std::string exprText(const Expr* expr);
+
+static std::string literalText(const Value& v) {
+    if (v.isString()) return "\"" + std::string(v.asString()) + "\"";
+    return v.toString();
+}
+
+// Expressions print on one line as s-expressions
+static std::string exprText(const Expr* expr) {
+    if (!expr) return "nil";
+    switch (expr->kind) {
+        case ExprKind::LITERAL:
+            return literalText(static_cast<const Literal*>(expr)->value);
+        case ExprKind::VARIABLE:
+            return std::string(static_cast<const Variable*>(expr)->name.asString());
+        case ExprKind::ASSIGN: {
+            auto* e = static_cast<const Assign*>(expr);
+            return "(= " + std::string(e->name.asString()) + " " + exprText(e->value) + ")";
+        }
+        case ExprKind::NEW:
+            return "(new " + std::string(static_cast<const New*>(expr)->className.asString()) + ")";
+        case ExprKind::GET: {
+            auto* e = static_cast<const Get*>(expr);
+            return "(. " + exprText(e->object) + " " + std::string(e->name.asString()) + ")";
+        }
+        case ExprKind::SET: {
+            auto* e = static_cast<const Set*>(expr);
+            return "(.= " + exprText(e->object) + " " + std::string(e->name.asString()) + " " + exprText(e->value) + ")";
+        }
+        case ExprKind::BINARY: {
+            auto* e = static_cast<const Binary*>(expr);
+            std::string text = std::string("(") + opText(e->op);
+            if (e->left) text += " " + exprText(e->left);
+            return text + " " + exprText(e->right) + ")";
+        }
+        case ExprKind::CALL: {
+            auto* e = static_cast<const Call*>(expr);
+            std::string text = "(call " + exprText(e->callee);
+            for (const Expr* arg : e->arguments) text += " " + exprText(arg);
+            return text + ")";
+        }
+    }
+    return "?";
+}
+
+// Statements print one per line, nested ones indented under their parent
+static void dumpStmt(const Stmt* stmt, int depth) {
+    std::printf("%*s", depth * 2, "");
+    switch (stmt->kind) {
+        case StmtKind::PRINT:
+            std::printf("(print %s)\n", exprText(static_cast<const PrintStmt*>(stmt)->expression).c_str());
+            break;
+        case StmtKind::EXPRESSION:
+            std::printf("%s\n", exprText(static_cast<const ExpressionStmt*>(stmt)->expression).c_str());
+            break;
+        case StmtKind::VAR: {
+            auto* s = static_cast<const VarStmt*>(stmt);
+            std::printf("(var %s %s)\n", std::string(s->name.asString()).c_str(), exprText(s->initializer).c_str());
+            break;
+        }
+        case StmtKind::WHILE: {
+            auto* s = static_cast<const WhileStmt*>(stmt);
+            std::printf("(while %s\n", exprText(s->condition).c_str());
+            dumpStmt(s->body, depth + 1);
+            std::printf("%*s)\n", depth * 2, "");
+            break;
+        }
+        case StmtKind::BLOCK: {
+            auto* s = static_cast<const Block*>(stmt);
+            std::printf("(block\n");
+            for (const Stmt* inner : s->statements) dumpStmt(inner, depth + 1);
+            std::printf("%*s)\n", depth * 2, "");
+            break;
+        }
+        case StmtKind::FUNCTION:
+            std::printf("(fun %s)\n", std::string(static_cast<const Function*>(stmt)->name.asString()).c_str());
+            break;
+        case StmtKind::CLASS:
+            std::printf("(class %s)\n", std::string(static_cast<const ClassStmt*>(stmt)->name.asString()).c_str());
+            break;
+    }
+}
+
+void dumpAst(const std::vector<Stmt*>& statements, const std::string& name) {
+    std::printf("== %s ==\n", name.c_str());
+    for (const Stmt* stmt : statements) dumpStmt(stmt, 0);
+}
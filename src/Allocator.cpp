@@ -0,0 +1,170 @@
+#include "Allocator.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <iomanip>
+#include <new>
+#include <string>
+
+constexpr size_t PoolAllocator::CLASS_SIZES[];
+
+// Cells start after the page header, rounded up so every cell is 16-aligned
+static constexpr size_t HEADER_SIZE = 64;
+// Large objects carry their size in front of them
+static constexpr size_t LARGE_HEADER = 16;
+
+static std::string percent(double share) {
+    char buf[16];
+    std::snprintf(buf, sizeof buf, "%.1f%%", 100.0 * share);
+    return buf;
+}
+
+// Empty pages kept for reuse beyond the number of pages still in use
+static constexpr size_t MIN_CACHED_PAGES = 64;
+
+PoolAllocator::~PoolAllocator() {
+    for (auto& cls : classes) {
+        for (Page* page : cls.pages) std::free(page);
+    }
+    for (void* mem : emptyPages) std::free(mem);
+}
+
+PoolAllocator::Page* PoolAllocator::newPage(uint8_t sizeClass) {
+    static_assert(sizeof(Page) <= HEADER_SIZE, "page header must fit before the first cell");
+    void* mem;
+    if (!emptyPages.empty()) {
+        mem = emptyPages.back();
+        emptyPages.pop_back();
+    } else {
+        mem = std::aligned_alloc(PAGE_SIZE, PAGE_SIZE);
+        if (mem == nullptr) throw std::bad_alloc();
+    }
+    auto* page = new (mem) Page();
+    page->cellSize = (uint32_t)CLASS_SIZES[sizeClass];
+    page->cellCount = (uint32_t)((PAGE_SIZE - HEADER_SIZE) / page->cellSize);
+    page->bump = static_cast<char*>(mem) + HEADER_SIZE;
+    page->end = page->bump + size_t(page->cellCount) * page->cellSize;
+    classes[sizeClass].pages.push_back(page);
+    return page;
+}
+
+void* PoolAllocator::allocateSlow(size_t size, uint8_t sizeClass) {
+    if (sizeClass == LARGE) {
+        char* mem = static_cast<char*>(std::malloc(size + LARGE_HEADER));
+        if (mem == nullptr) throw std::bad_alloc();
+        *reinterpret_cast<size_t*>(mem) = size;
+        largeCount++;
+        largeBytes += size;
+        return mem + LARGE_HEADER;
+    }
+
+    SizeClass& cls = classes[sizeClass];
+    while (!cls.available.empty()) {
+        Page* page = cls.available.back();
+        if (page->freeList) {
+            FreeCell* cell = page->freeList;
+            page->freeList = cell->next;
+            page->liveCells++;
+            return cell;
+        }
+        if (page->bump < page->end) {
+            void* cell = page->bump;
+            page->bump += page->cellSize;
+            page->liveCells++;
+            return cell;
+        }
+        page->available = false;
+        cls.available.pop_back();
+    }
+
+    Page* page = newPage(sizeClass);
+    page->available = true;
+    cls.available.push_back(page);
+    void* cell = page->bump;
+    page->bump += page->cellSize;
+    page->liveCells++;
+    return cell;
+}
+
+size_t PoolAllocator::blockSize(const void* ptr, uint8_t sizeClass) {
+    if (sizeClass != LARGE) return CLASS_SIZES[sizeClass];
+    return *reinterpret_cast<const size_t*>(static_cast<const char*>(ptr) - LARGE_HEADER);
+}
+
+void PoolAllocator::free(void* ptr, uint8_t sizeClass) {
+    if (sizeClass == LARGE) {
+        char* mem = static_cast<char*>(ptr) - LARGE_HEADER;
+        largeCount--;
+        largeBytes -= *reinterpret_cast<size_t*>(mem);
+        std::free(mem);
+        return;
+    }
+
+    Page* page = pageOf(ptr);
+    auto* cell = static_cast<FreeCell*>(ptr);
+    cell->next = page->freeList;
+    page->freeList = cell;
+    page->liveCells--;
+    if (!page->available) {
+        page->available = true;
+        classes[sizeClass].available.push_back(page);
+    }
+}
+
+void PoolAllocator::releaseEmptyPages() {
+    size_t inUse = 0;
+    for (auto& cls : classes) {
+        size_t kept = 0;
+        for (Page* page : cls.pages) {
+            if (page->liveCells == 0) emptyPages.push_back(page);
+            else cls.pages[kept++] = page;
+        }
+        cls.pages.resize(kept);
+        inUse += kept;
+        // Rebuild the list of pages with room from what survived
+        cls.available.clear();
+        for (Page* page : cls.pages) {
+            page->available = page->freeList != nullptr || page->bump < page->end;
+            if (page->available) cls.available.push_back(page);
+        }
+    }
+    size_t keep = std::max(MIN_CACHED_PAGES, inUse);
+    while (emptyPages.size() > keep) {
+        std::free(emptyPages.back());
+        emptyPages.pop_back();
+    }
+}
+
+size_t PoolAllocator::liveBytes() const {
+    size_t bytes = largeBytes;
+    for (const auto& cls : classes) {
+        for (const Page* page : cls.pages) bytes += size_t(page->liveCells) * page->cellSize;
+    }
+    return bytes;
+}
+
+// Fragmentation is the share of committed page memory not holding a live
+// object: free cells, never-used cells and the tail each page can't use.
+void PoolAllocator::dumpStats(std::ostream& out) const {
+    size_t totalPages = 0, totalLive = 0;
+    for (size_t i = 0; i < CLASS_COUNT; i++) {
+        const SizeClass& cls = classes[i];
+        if (cls.pages.empty()) continue;
+        size_t cells = 0, live = 0;
+        for (const Page* page : cls.pages) {
+            cells += page->cellCount;
+            live += page->liveCells;
+        }
+        size_t committed = cls.pages.size() * PAGE_SIZE;
+        double frag = 1.0 - double(live * CLASS_SIZES[i]) / double(committed);
+        out << "  " << std::setw(3) << CLASS_SIZES[i] << "B: " << std::setw(5) << cls.pages.size() << " pages, "
+            << std::setw(8) << live << "/" << cells << " cells live, "
+            << percent(frag) << " fragmentation\n";
+        totalPages += cls.pages.size();
+        totalLive += live * CLASS_SIZES[i];
+    }
+    double frag = totalPages ? 1.0 - double(totalLive) / double(totalPages * PAGE_SIZE) : 0.0;
+    out << "  total: " << totalPages << " pages (" << totalPages * PAGE_SIZE / 1024 << " KB), "
+        << totalLive << " bytes live in pages, " << percent(frag) << " fragmentation; "
+        << emptyPages.size() << " empty pages cached; " << largeCount << " large objects (" << largeBytes << " bytes)\n";
+}
@@ -0,0 +1,33 @@
+#include "Arena.h"
+#include <algorithm>
+#include <cstdlib>
+
+Arena::~Arena() {
+    for (Chunk& chunk : chunks) std::free(chunk.memory);
+}
+
+// Oversized requests get a chunk of their own
+void* Arena::allocateSlow(size_t size, size_t align) {
+    size_t chunkSize = std::max(CHUNK_BYTES, size + align);
+    char* memory = static_cast<char*>(std::malloc(chunkSize));
+    if (!memory) throw std::bad_alloc();
+    chunks.push_back({memory, chunkSize});
+    cursor = memory;
+    limit = memory + chunkSize;
+    return allocate(size, align);
+}
+
+void Arena::reset() {
+    for (size_t i = 1; i < chunks.size(); i++) std::free(chunks[i].memory);
+    if (chunks.size() > 1) chunks.resize(1);
+    cursor = chunks.empty() ? nullptr : chunks[0].memory;
+    limit = chunks.empty() ? nullptr : chunks[0].memory + chunks[0].size;
+    objects = 0;
+    bytes = 0;
+}
+
+size_t Arena::bytesReserved() const {
+    size_t total = 0;
+    for (const Chunk& chunk : chunks) total += chunk.size;
+    return total;
+}
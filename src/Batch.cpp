@@ -0,0 +1,148 @@
+#include "Batch.h"
+#include "ClosureCompiler.h"
+#include "Compiler.h"
+#include "Interpreter.h"
+#include "Isolate.h"
+#include "Lexer.h"
+#include "Optimizer.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Source.h"
+#include "VM.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <dirent.h>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+bool runScript(std::string_view source, const BatchOptions& options, const CodeCache& cache, std::ostream& out,
+               std::ostream& err) {
+    Chunk chunk;
+    try {
+        if (options.engine != "vm" || !cache.load(source, options.optLevel, chunk)) {
+            Lexer lexer(source);
+            lexer.diagnostics = &err;
+            Arena ast;
+            Parser parser(lexer, ast);
+            std::vector<Stmt*> statements = parser.parse();
+            try {
+                Resolver resolver;
+                resolver.resolve(statements);
+            } catch (std::runtime_error& e) {
+                err << "Resolve Error: " << e.what() << "\n";
+                return false;
+            }
+            if (options.optLevel >= 1) {
+                Optimizer optimizer(ast);
+                optimizer.optimize(statements);
+            }
+
+            if (options.engine != "vm") {
+                Interpreter interpreter(out, err);
+                if (options.engine == "closure")
+                    return ClosureCompiler::run(interpreter, ClosureCompiler(ast).link(statements));
+                return interpreter.interpret(statements);
+            }
+            Compiler compiler;
+            chunk = compiler.compile(statements);
+            // A cache hit skips the lexer, so its diagnostics would be lost
+            if (lexer.errors == 0) cache.store(source, options.optLevel, chunk);
+        }
+    } catch (std::runtime_error& e) {
+        err << "Error: " << e.what() << "\n";
+        return false;
+    }
+    VM vm(out, err);
+    return vm.interpret(chunk);
+}
+
+std::vector<std::string> listScripts(const std::string& directory) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) throw std::runtime_error("cannot open directory " + directory);
+    std::vector<std::string> paths;
+    std::string prefix = directory.back() == '/' ? directory : directory + "/";
+    while (dirent* entry = readdir(dir)) {
+        std::string_view name = entry->d_name;
+        const std::string_view ext = ".jlite";
+        if (name.size() > ext.size() && name.substr(name.size() - ext.size()) == ext)
+            paths.push_back(prefix + std::string(name));
+    }
+    closedir(dir);
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+namespace {
+
+struct Captured {
+    std::string output;
+    std::string errors;
+    bool ok = false;
+    bool done = false;
+};
+
+// Nothing from the script but its text outlives the isolate
+void runIsolated(const std::string& path, const BatchOptions& options, const CodeCache& cache, Captured& result) {
+    Isolate isolate;
+    Isolate::Scope scope(isolate);
+    if (options.configureHeap) options.configureHeap(isolate.heap);
+    std::ostringstream out, err;
+    try {
+        SourceBuffer source(path);
+        result.ok = runScript(source.text(), options, cache, out, err);
+    } catch (std::runtime_error& e) {
+        err << "Error: " << e.what() << "\n";
+    }
+    result.output = out.str();
+    result.errors = err.str();
+}
+
+} // namespace
+
+BatchResult runBatch(const std::vector<std::string>& paths, const BatchOptions& options, std::ostream& out,
+                     std::ostream& err) {
+    CodeCache cache(options.engine == "vm" ? options.cacheDirectory : "");
+    std::vector<Captured> results(paths.size());
+    std::atomic<size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    // Workers take scripts in order; this thread writes each result as soon
+    // as it is the next one due
+    std::vector<std::thread> workers;
+    size_t jobs = std::max<size_t>(1, std::min(options.jobs, paths.size()));
+    for (size_t w = 0; w < jobs; w++) {
+        workers.emplace_back([&] {
+            for (size_t i; (i = next++) < paths.size();) {
+                Captured captured;
+                runIsolated(paths[i], options, cache, captured);
+                {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    results[i] = std::move(captured);
+                    results[i].done = true;
+                }
+                finished.notify_one();
+            }
+        });
+    }
+
+    BatchResult summary;
+    summary.scripts = paths.size();
+    for (size_t i = 0; i < paths.size(); i++) {
+        Captured result;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&] { return results[i].done; });
+            result = std::move(results[i]);
+        }
+        if (!result.ok) summary.failed++;
+        out << "==> " << paths[i] << " <==\n" << result.output;
+        std::istringstream errors(result.errors);
+        for (std::string line; std::getline(errors, line);) err << paths[i] << ": " << line << "\n";
+    }
+    for (auto& t : workers) t.join();
+    return summary;
+}
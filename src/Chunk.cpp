@@ -0,0 +1,107 @@
+#include "Chunk.h"
+#include <cstdio>
+
+const char* opName(uint8_t op) {
+    switch (op) {
+        case OP_CONSTANT: return "OP_CONSTANT";
+        case OP_NIL: return "OP_NIL";
+        case OP_TRUE: return "OP_TRUE";
+        case OP_FALSE: return "OP_FALSE";
+        case OP_POP: return "OP_POP";
+        case OP_POPN: return "OP_POPN";
+        case OP_DEFINE_GLOBAL: return "OP_DEFINE_GLOBAL";
+        case OP_GET_GLOBAL: return "OP_GET_GLOBAL";
+        case OP_SET_GLOBAL: return "OP_SET_GLOBAL";
+        case OP_GET_LOCAL: return "OP_GET_LOCAL";
+        case OP_SET_LOCAL: return "OP_SET_LOCAL";
+        case OP_CLASS: return "OP_CLASS";
+        case OP_NEW: return "OP_NEW";
+        case OP_GET_FIELD: return "OP_GET_FIELD";
+        case OP_SET_FIELD: return "OP_SET_FIELD";
+        case OP_ADD: return "OP_ADD";
+        case OP_SUBTRACT: return "OP_SUBTRACT";
+        case OP_MULTIPLY: return "OP_MULTIPLY";
+        case OP_DIVIDE: return "OP_DIVIDE";
+        case OP_NEGATE: return "OP_NEGATE";
+        case OP_NOT: return "OP_NOT";
+        case OP_EQUAL: return "OP_EQUAL";
+        case OP_NOT_EQUAL: return "OP_NOT_EQUAL";
+        case OP_GREATER: return "OP_GREATER";
+        case OP_GREATER_EQUAL: return "OP_GREATER_EQUAL";
+        case OP_LESS: return "OP_LESS";
+        case OP_LESS_EQUAL: return "OP_LESS_EQUAL";
+        case OP_ADD_NUM: return "OP_ADD_NUM";
+        case OP_SUBTRACT_NUM: return "OP_SUBTRACT_NUM";
+        case OP_MULTIPLY_NUM: return "OP_MULTIPLY_NUM";
+        case OP_DIVIDE_NUM: return "OP_DIVIDE_NUM";
+        case OP_GREATER_NUM: return "OP_GREATER_NUM";
+        case OP_GREATER_EQUAL_NUM: return "OP_GREATER_EQUAL_NUM";
+        case OP_LESS_NUM: return "OP_LESS_NUM";
+        case OP_LESS_EQUAL_NUM: return "OP_LESS_EQUAL_NUM";
+        case OP_ADD_STR: return "OP_ADD_STR";
+        case OP_JUMP_IF_FALSE: return "OP_JUMP_IF_FALSE";
+        case OP_LOOP: return "OP_LOOP";
+        case OP_PRINT: return "OP_PRINT";
+        case OP_RETURN: return "OP_RETURN";
+    }
+    return "OP_UNKNOWN";
+}
+
+void Chunk::disassemble(const std::string& name) const {
+    std::printf("== %s ==\n", name.c_str());
+    for (size_t offset = 0; offset < code.size();) {
+        offset = disassembleInstruction(offset);
+    }
+}
+
+size_t Chunk::disassembleInstruction(size_t offset) const {
+    std::printf("%04zu ", offset);
+    if (offset > 0 && lines[offset] == lines[offset - 1]) std::printf("   | ");
+    else std::printf("%4d ", lines[offset]);
+
+    uint8_t op = code[offset];
+    switch (op) {
+        case OP_DEFINE_GLOBAL: case OP_GET_GLOBAL: case OP_SET_GLOBAL: {
+            size_t index = (size_t(code[offset + 1]) << 16) | (size_t(code[offset + 2]) << 8) | code[offset + 3];
+            const char* name = index < globalNames.size() ? globalNames[index].c_str() : "?";
+            std::printf("%-16s %6zu '%s'\n", opName(op), index, name);
+            return offset + 4;
+        }
+        case OP_GET_FIELD: case OP_SET_FIELD: {
+            size_t index = (size_t(code[offset + 1]) << 16) | (size_t(code[offset + 2]) << 8) | code[offset + 3];
+            size_t cache = (size_t(code[offset + 4]) << 16) | (size_t(code[offset + 5]) << 8) | code[offset + 6];
+            std::printf("%-16s %6zu '%s' ic %zu\n", opName(op), index, constants[index].toString().c_str(), cache);
+            return offset + 7;
+        }
+        case OP_ADD: case OP_SUBTRACT: case OP_MULTIPLY: case OP_DIVIDE:
+        case OP_GREATER: case OP_GREATER_EQUAL: case OP_LESS: case OP_LESS_EQUAL:
+        case OP_ADD_NUM: case OP_SUBTRACT_NUM: case OP_MULTIPLY_NUM: case OP_DIVIDE_NUM:
+        case OP_GREATER_NUM: case OP_GREATER_EQUAL_NUM: case OP_LESS_NUM: case OP_LESS_EQUAL_NUM:
+        case OP_ADD_STR: {
+            size_t site = (size_t(code[offset + 1]) << 16) | (size_t(code[offset + 2]) << 8) | code[offset + 3];
+            std::printf("%-16s %6s fb %zu\n", opName(op), "", site);
+            return offset + 4;
+        }
+        case OP_JUMP_IF_FALSE: case OP_LOOP: {
+            size_t jump = (size_t(code[offset + 1]) << 16) | (size_t(code[offset + 2]) << 8) | code[offset + 3];
+            long target = long(offset) + 4 + (op == OP_LOOP ? -long(jump) : long(jump));
+            std::printf("%-16s %6zu -> %ld\n", opName(op), offset, target);
+            return offset + 4;
+        }
+        case OP_CONSTANT:
+        case OP_CLASS: case OP_NEW: {
+            size_t index = (size_t(code[offset + 1]) << 16) | (size_t(code[offset + 2]) << 8) | code[offset + 3];
+            std::printf("%-16s %6zu '%s'\n", opName(op), index, constants[index].toString().c_str());
+            return offset + 4;
+        }
+        case OP_POPN:
+        case OP_GET_LOCAL: case OP_SET_LOCAL: {
+            size_t slot = (size_t(code[offset + 1]) << 8) | code[offset + 2];
+            std::printf("%-16s %6zu\n", opName(op), slot);
+            return offset + 3;
+        }
+        default:
+            std::printf("%s\n", opName(op));
+            return offset + 1;
+    }
+}
@@ -0,0 +1,421 @@
+#include "ClosureCompiler.h"
+#include <stdexcept>
+#include <type_traits>
+
+// Every node runs through one of these, which count it by kind for --stats
+// like Interpreter::evaluate and execute do
+static inline Value evaluate(ExprClosure* node, Interpreter& in) {
+    JLITE_COUNT(in.stats.exprs[size_t(node->kind)]++);
+    return node->eval(node, in);
+}
+
+static inline void execute(StmtClosure* node, Interpreter& in) {
+    JLITE_COUNT(in.stats.stmts[size_t(node->kind)]++);
+    node->exec(node, in);
+}
+
+// --- Expressions ---
+static Value literal(ExprClosure* self, Interpreter&) {
+    return self->value;
+}
+
+static Value getGlobal(ExprClosure* self, Interpreter& in) {
+    return in.globals[self->slot];
+}
+
+// The innermost two scopes are the common case and skip the walk up the chain
+static Value getLocal0(ExprClosure* self, Interpreter& in) {
+    JLITE_COUNT(in.stats.envLookups++);
+    return in.environment->values[self->slot];
+}
+
+static Value getLocal1(ExprClosure* self, Interpreter& in) {
+    JLITE_COUNT(in.stats.envLookups++, in.stats.envHops++);
+    return in.environment->enclosing->values[self->slot];
+}
+
+static Value getLocal(ExprClosure* self, Interpreter& in) {
+    JLITE_COUNT(in.stats.envLookups++, in.stats.envHops += self->depth);
+    return in.environment->get(self->depth, self->slot);
+}
+
+static Value setGlobal(ExprClosure* self, Interpreter& in) {
+    Value val = evaluate(self->left, in);
+    in.globals[self->slot] = val;
+    return val;
+}
+
+static Value setLocal0(ExprClosure* self, Interpreter& in) {
+    Value val = evaluate(self->left, in);
+    JLITE_COUNT(in.stats.envLookups++);
+    in.environment->values[self->slot] = val;
+    return val;
+}
+
+static Value setLocal(ExprClosure* self, Interpreter& in) {
+    Value val = evaluate(self->left, in);
+    JLITE_COUNT(in.stats.envLookups++, in.stats.envHops += self->depth);
+    in.environment->assign(self->depth, self->slot, val);
+    return val;
+}
+
+static Value newInstance(ExprClosure* self, Interpreter& in) {
+    size_t name = self->value.asHandle();
+    if (in.classes.find(name) == in.classes.end())
+        throw std::runtime_error("Unknown class " + std::string(self->value.asString()));
+    return Value::instance(in.heap.allocate<InstanceObject>(Shape::root(name)));
+}
+
+static Value getField(ExprClosure* self, Interpreter& in) {
+    Value obj = evaluate(self->left, in);
+    if (!obj.isInstance()) throw std::runtime_error("Only instances have properties.");
+    auto* io = static_cast<InstanceObject*>(in.heap.get(obj.asHandle()));
+    return self->ic->get(io, self->value.asHandle());
+}
+
+static Value setField(ExprClosure* self, Interpreter& in) {
+    Value obj = evaluate(self->left, in);
+    if (!obj.isInstance()) throw std::runtime_error("Only instances have fields.");
+    in.tempRoots.push_back(obj);
+    Value val = evaluate(self->right, in);
+    in.tempRoots.pop_back();
+    auto* io = static_cast<InstanceObject*>(in.heap.get(obj.asHandle()));
+    self->ic->set(io, self->value.asHandle(), val);
+    return val;
+}
+
+static Value call(ExprClosure*, Interpreter&) {
+    return Value::nil(); // calls are not implemented yet
+}
+
+// --- Operators ---
+// Each operator gets its own closures; Op supplies the result for two numbers.
+struct Add          { static Value numbers(double a, double b) { return Value::number(a + b); } };
+struct Subtract     { static Value numbers(double a, double b) { return Value::number(a - b); } };
+struct Multiply     { static Value numbers(double a, double b) { return Value::number(a * b); } };
+struct Divide       { static Value numbers(double a, double b) { return Value::number(a / b); } };
+struct Greater      { static Value numbers(double a, double b) { return Value::boolean(a > b); } };
+struct GreaterEqual { static Value numbers(double a, double b) { return Value::boolean(a >= b); } };
+struct Less         { static Value numbers(double a, double b) { return Value::boolean(a < b); } };
+struct LessEqual    { static Value numbers(double a, double b) { return Value::boolean(a <= b); } };
+
+static Value concat(const Value& a, const Value& b) {
+    return Value::string(std::string(a.asString()) + std::string(b.asString()));
+}
+
+// The operator's unspecialized semantics
+template <typename Op>
+static Value apply(const Value& left, const Value& right) {
+    if (left.isNumber() && right.isNumber()) return Op::numbers(left.asNumber(), right.asNumber());
+    if (std::is_same<Op, Add>::value) {
+        if (left.isString() && right.isString()) return concat(left, right);
+        throw std::runtime_error("Operands must be two numbers or two strings.");
+    }
+    throw std::runtime_error("Operands must be numbers.");
+}
+
+// Evaluates both operands, keeping the left one rooted while the right runs
+static void operands(ExprClosure* self, Interpreter& in, Value& left, Value& right) {
+    left = evaluate(self->left, in);
+    in.tempRoots.push_back(left);
+    right = evaluate(self->right, in);
+    in.tempRoots.pop_back();
+}
+
+template <typename Op> static Value numberOp(ExprClosure* self, Interpreter& in);
+static Value stringAdd(ExprClosure* self, Interpreter& in);
+
+// An unspecialized site; the first execution picks its specialized closure
+template <typename Op>
+static Value genericOp(ExprClosure* self, Interpreter& in) {
+    Value left, right;
+    operands(self, in, left, right);
+    BinaryFeedback& site = *self->feedback;
+    if (site.state == BinaryFeedback::UNINITIALIZED) {
+        switch (site.specialize(left, right)) {
+            case BinaryFeedback::NUMBER: self->eval = numberOp<Op>; break;
+            case BinaryFeedback::STRING: self->eval = stringAdd; break;
+            default: break;
+        }
+    }
+    return apply<Op>(left, right);
+}
+
+// A failed guard: back to the generic closure for good
+static void deoptimize(ExprClosure* self, EvalFn generic) {
+    self->feedback->deoptimize();
+    self->eval = generic;
+}
+
+template <typename Op>
+static Value numberOp(ExprClosure* self, Interpreter& in) {
+    Value left = evaluate(self->left, in);
+    if (left.isNumber()) {
+        // A number needs no root while the right operand runs
+        Value right = evaluate(self->right, in);
+        if (right.isNumber()) {
+            self->feedback->hits++;
+            return Op::numbers(left.asNumber(), right.asNumber());
+        }
+        deoptimize(self, genericOp<Op>);
+        return apply<Op>(left, right);
+    }
+    in.tempRoots.push_back(left);
+    Value right = evaluate(self->right, in);
+    in.tempRoots.pop_back();
+    deoptimize(self, genericOp<Op>);
+    return apply<Op>(left, right);
+}
+
+static Value stringAdd(ExprClosure* self, Interpreter& in) {
+    Value left, right;
+    operands(self, in, left, right);
+    if (left.isString() && right.isString()) {
+        self->feedback->hits++;
+        return concat(left, right);
+    }
+    deoptimize(self, genericOp<Add>);
+    return apply<Add>(left, right);
+}
+
+static Value equal(ExprClosure* self, Interpreter& in) {
+    Value left, right;
+    operands(self, in, left, right);
+    return Value::boolean(left == right);
+}
+
+static Value notEqual(ExprClosure* self, Interpreter& in) {
+    Value left, right;
+    operands(self, in, left, right);
+    return Value::boolean(!(left == right));
+}
+
+static Value negate(ExprClosure* self, Interpreter& in) {
+    Value right = evaluate(self->right, in);
+    if (!right.isNumber()) throw std::runtime_error("Operand must be a number.");
+    return Value::number(-right.asNumber());
+}
+
+static Value logicalNot(ExprClosure* self, Interpreter& in) {
+    return Value::boolean(!evaluate(self->right, in).isTruthy());
+}
+
+static EvalFn binaryOp(TokenType op) {
+    switch (op) {
+        case PLUS:          return genericOp<Add>;
+        case MINUS:         return genericOp<Subtract>;
+        case STAR:          return genericOp<Multiply>;
+        case SLASH:         return genericOp<Divide>;
+        case GREATER:       return genericOp<Greater>;
+        case GREATER_EQUAL: return genericOp<GreaterEqual>;
+        case LESS:          return genericOp<Less>;
+        case LESS_EQUAL:    return genericOp<LessEqual>;
+        case EQUAL_EQUAL:   return equal;
+        case BANG_EQUAL:    return notEqual;
+        default:
+            throw std::runtime_error("Unknown or unhandled operator.");
+    }
+}
+
+// --- Statements ---
+static void print(StmtClosure* self, Interpreter& in) {
+    in.out << evaluate(self->expr, in).toString() << "\n";
+}
+
+static void expression(StmtClosure* self, Interpreter& in) {
+    evaluate(self->expr, in);
+}
+
+// Globals grow as they are declared
+static void defineGlobal(StmtClosure* self, Interpreter& in) {
+    Value val = self->expr ? evaluate(self->expr, in) : Value::nil();
+    if (self->slot >= (int)in.globals.size()) in.globals.resize(self->slot + 1);
+    in.globals[self->slot] = val;
+}
+
+static void defineLocal(StmtClosure* self, Interpreter& in) {
+    Value val = self->expr ? evaluate(self->expr, in) : Value::nil();
+    in.environment->define(self->slot, val);
+}
+
+static void declareClass(StmtClosure* self, Interpreter& in) {
+    in.classes[self->declaration->name.asHandle()] = self->declaration;
+}
+
+// Loops and blocks come in two versions, chosen at link time: with PROFILE
+// they keep the interpreter's shadow stack like Interpreter::execute does
+template <bool PROFILE>
+static void loop(StmtClosure* self, Interpreter& in) {
+    ExprClosure* condition = self->expr;
+    StmtClosure* body = self->body;
+    while (evaluate(condition, in).isTruthy()) {
+        if constexpr (PROFILE) {
+            in.shadow->enter();
+            in.shadow->at(body->line);
+        }
+        execute(body, in);
+        if constexpr (PROFILE) in.shadow->leave();
+    }
+}
+
+// Same scope handling as Interpreter::executeBlock
+template <bool PROFILE>
+static void block(StmtClosure* self, Interpreter& in) {
+    size_t slotCount = self->slot;
+    Environment env(in.environment, in.scopes.push(slotCount), slotCount);
+    Environment* previous = in.environment;
+    in.environment = &env;
+    try {
+        for (StmtClosure* stmt : self->statements) {
+            if constexpr (PROFILE) in.shadow->at(stmt->line);
+            execute(stmt, in);
+        }
+    } catch (...) {
+        in.environment = previous;
+        in.scopes.pop(slotCount);
+        throw;
+    }
+    in.environment = previous;
+    in.scopes.pop(slotCount);
+}
+
+static void nothing(StmtClosure*, Interpreter&) {}
+
+// --- Linking ---
+std::vector<StmtClosure*> ClosureCompiler::link(const std::vector<Stmt*>& statements) {
+    std::vector<StmtClosure*> program;
+    program.reserve(statements.size());
+    for (Stmt* stmt : statements) program.push_back(linkStmt(stmt));
+    return program;
+}
+
+bool ClosureCompiler::run(Interpreter& interpreter, const std::vector<StmtClosure*>& program) {
+    ShadowStack* shadow = interpreter.shadow;
+    try {
+        if (shadow) shadow->enter();
+        for (StmtClosure* stmt : program) {
+            if (shadow) shadow->at(stmt->line);
+            execute(stmt, interpreter);
+        }
+        if (shadow) shadow->leave();
+        return true;
+    } catch (std::runtime_error& e) {
+        interpreter.err << "Runtime Error: " << e.what() << "\n";
+        if (shadow) shadow->clear();
+        return false;
+    }
+}
+
+ExprClosure* ClosureCompiler::linkExpr(Expr* expr) {
+    switch (expr->kind) {
+        case ExprKind::LITERAL: {
+            ExprClosure* c = arena.make<ExprClosure>(literal, expr->kind);
+            c->value = static_cast<Literal*>(expr)->value;
+            return c;
+        }
+        case ExprKind::VARIABLE: {
+            auto* e = static_cast<Variable*>(expr);
+            EvalFn fn = e->depth < 0 ? getGlobal : e->depth == 0 ? getLocal0 : e->depth == 1 ? getLocal1 : getLocal;
+            ExprClosure* c = arena.make<ExprClosure>(fn, expr->kind);
+            c->depth = e->depth;
+            c->slot = e->slot;
+            return c;
+        }
+        case ExprKind::ASSIGN: {
+            auto* e = static_cast<Assign*>(expr);
+            ExprClosure* c = arena.make<ExprClosure>(e->depth < 0 ? setGlobal : e->depth == 0 ? setLocal0 : setLocal, expr->kind);
+            c->left = linkExpr(e->value);
+            c->depth = e->depth;
+            c->slot = e->slot;
+            return c;
+        }
+        case ExprKind::NEW: {
+            ExprClosure* c = arena.make<ExprClosure>(newInstance, expr->kind);
+            c->value = static_cast<New*>(expr)->className;
+            return c;
+        }
+        case ExprKind::GET: {
+            auto* e = static_cast<Get*>(expr);
+            ExprClosure* c = arena.make<ExprClosure>(getField, expr->kind);
+            c->left = linkExpr(e->object);
+            c->value = e->name;
+            c->ic = &e->ic;
+            return c;
+        }
+        case ExprKind::SET: {
+            auto* e = static_cast<Set*>(expr);
+            ExprClosure* c = arena.make<ExprClosure>(setField, expr->kind);
+            c->left = linkExpr(e->object);
+            c->right = linkExpr(e->value);
+            c->value = e->name;
+            c->ic = &e->ic;
+            return c;
+        }
+        case ExprKind::BINARY: {
+            auto* e = static_cast<Binary*>(expr);
+            // Unary operators are a Binary without a left operand
+            if (!e->left) {
+                ExprClosure* c = arena.make<ExprClosure>(e->op == BANG ? logicalNot : negate, expr->kind);
+                c->right = linkExpr(e->right);
+                return c;
+            }
+            ExprClosure* c = arena.make<ExprClosure>(binaryOp(e->op), expr->kind);
+            c->left = linkExpr(e->left);
+            c->right = linkExpr(e->right);
+            c->feedback = &e->feedback;
+            return c;
+        }
+        case ExprKind::CALL:
+            break;
+    }
+    return arena.make<ExprClosure>(call, expr->kind);
+}
+
+StmtClosure* ClosureCompiler::linkStmt(Stmt* stmt) {
+    switch (stmt->kind) {
+        case StmtKind::PRINT: {
+            StmtClosure* c = arena.make<StmtClosure>(print, stmt->kind, stmt->line);
+            c->expr = linkExpr(static_cast<PrintStmt*>(stmt)->expression);
+            return c;
+        }
+        case StmtKind::EXPRESSION: {
+            StmtClosure* c = arena.make<StmtClosure>(expression, stmt->kind, stmt->line);
+            c->expr = linkExpr(static_cast<ExpressionStmt*>(stmt)->expression);
+            return c;
+        }
+        case StmtKind::VAR: {
+            auto* s = static_cast<VarStmt*>(stmt);
+            StmtClosure* c = arena.make<StmtClosure>(blockDepth == 0 ? defineGlobal : defineLocal, stmt->kind, stmt->line);
+            if (s->initializer) c->expr = linkExpr(s->initializer);
+            c->slot = s->slot;
+            return c;
+        }
+        case StmtKind::CLASS: {
+            StmtClosure* c = arena.make<StmtClosure>(declareClass, stmt->kind, stmt->line);
+            c->declaration = static_cast<ClassStmt*>(stmt);
+            return c;
+        }
+        case StmtKind::WHILE: {
+            auto* s = static_cast<WhileStmt*>(stmt);
+            StmtClosure* c = arena.make<StmtClosure>(profile ? loop<true> : loop<false>, stmt->kind, stmt->line);
+            c->expr = linkExpr(s->condition);
+            c->body = linkStmt(s->body);
+            return c;
+        }
+        case StmtKind::BLOCK: {
+            auto* s = static_cast<Block*>(stmt);
+            StmtClosure* c = arena.make<StmtClosure>(profile ? block<true> : block<false>, stmt->kind, stmt->line);
+            std::vector<StmtClosure*> body;
+            body.reserve(s->statements.size());
+            blockDepth++;
+            for (Stmt* inner : s->statements) body.push_back(linkStmt(inner));
+            blockDepth--;
+            c->statements = {arena.copy(body.data(), body.size()), uint32_t(body.size())};
+            c->slot = s->slotCount;
+            return c;
+        }
+        case StmtKind::FUNCTION:
+            break;
+    }
+    return arena.make<StmtClosure>(nothing, stmt->kind, stmt->line);
+}
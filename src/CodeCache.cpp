@@ -0,0 +1,249 @@
+#include "CodeCache.h"
+#include "Source.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#ifndef JLITE_VERSION
+#define JLITE_VERSION "dev"
+#endif
+
+// Bump whenever the bytecode or the layout below changes. The opcode count
+// is recorded as well, to catch a new opcode without a version bump.
+static const uint32_t FORMAT_VERSION = 2;
+static const uint32_t MAGIC = 0x43424c4a; // "JLBC" little-endian; a byte-swapped host sees garbage
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t opcodes;
+    uint32_t optLevel;
+    uint64_t buildId;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint64_t payloadSize;
+    uint64_t payloadHash;
+};
+
+// Word-at-a-time 64-bit hash. Not cryptographic: it only has to tell
+// scripts apart and catch damaged entries.
+static uint64_t hashBytes(std::string_view bytes) {
+    const uint64_t K = 0x9e3779b97f4a7c15ull;
+    uint64_t h = bytes.size() * K;
+    size_t i = 0;
+    for (; i + 8 <= bytes.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes.data() + i, 8);
+        h = (h ^ word) * K;
+        h ^= h >> 29;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, bytes.data() + i, bytes.size() - i);
+    h = (h ^ tail) * K;
+    return h ^ (h >> 32);
+}
+
+// The interpreter version and build options: an entry written by another
+// build is never used, even when the format and the opcodes are unchanged
+static uint64_t buildId() {
+    static const uint64_t id = hashBytes(std::string(JLITE_VERSION) +
+                                         " nan-boxing=" + std::to_string(JLITE_NAN_BOXING) +
+                                         " stats=" + std::to_string(JLITE_STATS));
+    return id;
+}
+
+// --- Payload encoding: native byte order, lengths as uint32 ---
+namespace {
+
+struct Writer {
+    std::string out;
+
+    template <typename T>
+    void put(T value) { out.append(reinterpret_cast<const char*>(&value), sizeof value); }
+    void putString(std::string_view s) {
+        put(uint32_t(s.size()));
+        out.append(s);
+    }
+};
+
+// Every read is bounds-checked; a short entry throws
+struct Reader {
+    const char* p;
+    const char* end;
+
+    std::string_view bytes(size_t n) {
+        if (size_t(end - p) < n) throw std::runtime_error("truncated cache entry");
+        std::string_view s(p, n);
+        p += n;
+        return s;
+    }
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, bytes(sizeof value).data(), sizeof value);
+        return value;
+    }
+    std::string_view getString() { return bytes(get<uint32_t>()); }
+};
+
+} // namespace
+
+static std::string serialize(const Chunk& chunk) {
+    Writer w;
+    w.putString(std::string_view(reinterpret_cast<const char*>(chunk.code.data()), chunk.code.size()));
+    // Lines as (line, bytes of code) runs: every byte of an instruction and
+    // usually whole statements share one
+    for (size_t i = 0; i < chunk.lines.size();) {
+        size_t run = i + 1;
+        while (run < chunk.lines.size() && chunk.lines[run] == chunk.lines[i]) run++;
+        w.put(int32_t(chunk.lines[i]));
+        w.put(uint32_t(run - i));
+        i = run;
+    }
+
+    w.put(uint32_t(chunk.constants.size()));
+    for (const Value& v : chunk.constants) {
+        // The compiler only pools numbers and strings
+        if (v.isNumber()) {
+            w.put(uint8_t(0));
+            w.put(v.asNumber());
+        } else {
+            w.put(uint8_t(1));
+            w.putString(v.asString());
+        }
+    }
+    w.put(uint32_t(chunk.globalNames.size()));
+    for (const std::string& name : chunk.globalNames) w.putString(name);
+    w.put(uint32_t(chunk.caches.size()));
+    for (const InlineCache& ic : chunk.caches) {
+        w.put(uint8_t(ic.kind));
+        w.put(int32_t(ic.line));
+    }
+    w.put(uint32_t(chunk.feedback.size()));
+    for (const BinaryFeedback& site : chunk.feedback) {
+        w.put(uint8_t(site.op));
+        w.put(int32_t(site.line));
+    }
+    return std::move(w.out);
+}
+
+static Chunk deserialize(std::string_view payload) {
+    Reader r{payload.data(), payload.data() + payload.size()};
+    Chunk chunk;
+    std::string_view code = r.getString();
+    chunk.code.assign(code.begin(), code.end());
+    chunk.lines.reserve(code.size());
+    while (chunk.lines.size() < code.size()) {
+        int line = r.get<int32_t>();
+        uint32_t run = r.get<uint32_t>();
+        if (run == 0 || run > code.size() - chunk.lines.size()) throw std::runtime_error("bad line table in cache entry");
+        chunk.lines.insert(chunk.lines.end(), run, line);
+    }
+
+    uint32_t count = r.get<uint32_t>();
+    chunk.constants.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        if (r.get<uint8_t>() == 0) {
+            chunk.constants.push_back(Value::number(r.get<double>()));
+            continue;
+        }
+        // Pinned like the parser's string literals
+        Value s = Value::string(r.getString());
+        Heap::current().pin(s);
+        chunk.constants.push_back(s);
+    }
+    count = r.get<uint32_t>();
+    for (uint32_t i = 0; i < count; i++) chunk.globalNames.emplace_back(r.getString());
+    count = r.get<uint32_t>();
+    for (uint32_t i = 0; i < count; i++) {
+        auto kind = InlineCache::Kind(r.get<uint8_t>());
+        chunk.caches.emplace_back(kind, r.get<int32_t>());
+    }
+    count = r.get<uint32_t>();
+    for (uint32_t i = 0; i < count; i++) {
+        auto op = TokenType(r.get<uint8_t>());
+        chunk.feedback.emplace_back(op, r.get<int32_t>());
+    }
+    if (r.p != r.end) throw std::runtime_error("trailing bytes in cache entry");
+    return chunk;
+}
+
+CodeCache::CodeCache(std::string directory) : directory(std::move(directory)) {}
+
+std::string CodeCache::defaultDirectory() {
+    if (const char* dir = std::getenv("JLITE_CACHE_DIR")) return dir;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) return std::string(xdg) + "/jlite";
+    if (const char* home = std::getenv("HOME"); home && *home) return std::string(home) + "/.cache/jlite";
+    return "";
+}
+
+std::string CodeCache::entryPath(std::string_view source, int optLevel) const {
+    return entryPath(hashBytes(source), optLevel);
+}
+
+// Builds sharing a directory get their own entries instead of overwriting
+// each other's
+std::string CodeCache::entryPath(uint64_t sourceHash, int optLevel) const {
+    char name[48];
+    std::snprintf(name, sizeof name, "/%016llx-O%d.jlc", (unsigned long long)(sourceHash ^ buildId()), optLevel);
+    return directory + name;
+}
+
+bool CodeCache::load(std::string_view source, int optLevel, Chunk& chunk) const {
+    if (directory.empty()) return false;
+    uint64_t sourceHash = hashBytes(source);
+    std::string path = entryPath(sourceHash, optLevel);
+    if (access(path.c_str(), R_OK) != 0) return false;
+    try {
+        SourceBuffer entry(path); // mapped like a script
+        std::string_view bytes = entry.text();
+        Header header;
+        if (bytes.size() < sizeof header) return false;
+        std::memcpy(&header, bytes.data(), sizeof header);
+        std::string_view payload = bytes.substr(sizeof header);
+        if (header.magic != MAGIC || header.version != FORMAT_VERSION || header.opcodes != OP_RETURN + 1 ||
+            header.optLevel != uint32_t(optLevel) || header.buildId != buildId() || header.sourceSize != source.size() ||
+            header.sourceHash != sourceHash || header.payloadSize != payload.size() ||
+            header.payloadHash != hashBytes(payload))
+            return false;
+        chunk = deserialize(payload);
+        return true;
+    } catch (std::runtime_error&) {
+        return false;
+    }
+}
+
+// Creates the directory and its parent if needed (~/.cache may not exist)
+static bool makeDirectory(const std::string& path) {
+    if (mkdir(path.c_str(), 0755) == 0 || errno == EEXIST) return true;
+    size_t slash = path.find_last_of('/');
+    if (errno != ENOENT || slash == 0 || slash == std::string::npos) return false;
+    if (!makeDirectory(path.substr(0, slash))) return false;
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+void CodeCache::store(std::string_view source, int optLevel, const Chunk& chunk) const {
+    if (directory.empty() || !makeDirectory(directory)) return;
+    std::string payload = serialize(chunk);
+    uint64_t sourceHash = hashBytes(source);
+    Header header{MAGIC, FORMAT_VERSION, OP_RETURN + 1, uint32_t(optLevel), buildId(), sourceHash,
+                  source.size(), payload.size(), hashBytes(payload)};
+
+    // Written to a file private to this process and thread (batch runs store
+    // from several) and renamed into place, so a concurrent run never maps a
+    // half-written entry
+    std::string path = entryPath(sourceHash, optLevel);
+    std::string temp = path + ".tmp." + std::to_string(getpid()) + "." +
+                       std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    FILE* file = std::fopen(temp.c_str(), "wb");
+    if (!file) return;
+    bool ok = std::fwrite(&header, sizeof header, 1, file) == 1 &&
+              std::fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) std::remove(temp.c_str());
+}
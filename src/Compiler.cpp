@@ -0,0 +1,241 @@
+#include "Compiler.h"
+#include <cstring>
+#include <stdexcept>
+
+Chunk Compiler::compile(const std::vector<Stmt*>& statements) {
+    for (Stmt* stmt : statements) {
+        compileStmt(stmt);
+    }
+    emit(OP_RETURN);
+    return std::move(chunk);
+}
+
+void Compiler::compileStmt(Stmt* stmt) {
+    switch (stmt->kind) {
+        case StmtKind::PRINT:
+            compileExpr(static_cast<PrintStmt*>(stmt)->expression);
+            emit(OP_PRINT);
+            break;
+        case StmtKind::EXPRESSION:
+            compileExpr(static_cast<ExpressionStmt*>(stmt)->expression);
+            emit(OP_POP);
+            break;
+        case StmtKind::VAR: {
+            auto* s = static_cast<VarStmt*>(stmt);
+            line = s->line;
+            if (s->initializer) compileExpr(s->initializer);
+            else emit(OP_NIL);
+
+            if (scopes.empty()) {
+                if (s->slot >= (int)chunk.globalNames.size()) chunk.globalNames.resize(s->slot + 1);
+                chunk.globalNames[s->slot] = s->name.asString();
+                emitIndex(OP_DEFINE_GLOBAL, s->slot);
+                break;
+            }
+            // A first declaration leaves its value on the stack as the new slot;
+            // redeclaring in the same block overwrites the existing slot.
+            Scope& scope = scopes.back();
+            if (s->slot < scope.pushed) {
+                emitSlot(OP_SET_LOCAL, scope.base + s->slot);
+                emit(OP_POP);
+            } else {
+                if (scope.base + s->slot > UINT16_MAX) throw std::runtime_error("Too many local variables in scope.");
+                scope.pushed++;
+            }
+            break;
+        }
+        case StmtKind::CLASS: {
+            auto* s = static_cast<ClassStmt*>(stmt);
+            line = s->line;
+            emitIndex(OP_CLASS, stringConstant(s->name));
+            break;
+        }
+        case StmtKind::WHILE: {
+            auto* s = static_cast<WhileStmt*>(stmt);
+            size_t loopStart = chunk.code.size();
+            compileExpr(s->condition);
+            size_t exitJump = emitJump(OP_JUMP_IF_FALSE);
+            compileStmt(s->body);
+            emitLoop(loopStart);
+            patchJump(exitJump);
+            break;
+        }
+        case StmtKind::BLOCK: {
+            auto* s = static_cast<Block*>(stmt);
+            int base = scopes.empty() ? 0 : scopes.back().base + scopes.back().pushed;
+            scopes.push_back({base, 0});
+            for (Stmt* inner : s->statements) compileStmt(inner);
+            int count = scopes.back().pushed;
+            scopes.pop_back();
+            if (count == 1) emit(OP_POP);
+            else if (count > 1) emitSlot(OP_POPN, count);
+            break;
+        }
+        case StmtKind::FUNCTION:
+            break;
+    }
+}
+
+void Compiler::compileExpr(Expr* expr) {
+    if (!expr) {
+        emit(OP_NIL);
+        return;
+    }
+    switch (expr->kind) {
+        case ExprKind::LITERAL: {
+            const Value& v = static_cast<Literal*>(expr)->value;
+            if (v.isNumber()) emitIndex(OP_CONSTANT, numberConstant(v.asNumber()));
+            else if (v.isString()) emitIndex(OP_CONSTANT, stringConstant(v));
+            else if (v.isBool()) emit(v.asBool() ? OP_TRUE : OP_FALSE);
+            else emit(OP_NIL);
+            break;
+        }
+        case ExprKind::VARIABLE: {
+            auto* e = static_cast<Variable*>(expr);
+            line = e->line;
+            if (e->depth >= 0) emitSlot(OP_GET_LOCAL, localSlot(e->depth, e->slot));
+            else emitIndex(OP_GET_GLOBAL, e->slot);
+            break;
+        }
+        case ExprKind::ASSIGN: {
+            auto* e = static_cast<Assign*>(expr);
+            compileExpr(e->value);
+            line = e->line;
+            if (e->depth >= 0) emitSlot(OP_SET_LOCAL, localSlot(e->depth, e->slot));
+            else emitIndex(OP_SET_GLOBAL, e->slot);
+            break;
+        }
+        case ExprKind::NEW: {
+            auto* e = static_cast<New*>(expr);
+            line = e->line;
+            emitIndex(OP_NEW, stringConstant(e->className));
+            break;
+        }
+        case ExprKind::GET: {
+            auto* e = static_cast<Get*>(expr);
+            compileExpr(e->object);
+            emitField(OP_GET_FIELD, e->name, e->ic.line);
+            break;
+        }
+        case ExprKind::SET: {
+            auto* e = static_cast<Set*>(expr);
+            compileExpr(e->object);
+            compileExpr(e->value);
+            emitField(OP_SET_FIELD, e->name, e->ic.line);
+            break;
+        }
+        case ExprKind::BINARY: {
+            auto* e = static_cast<Binary*>(expr);
+            // The parser encodes unary operators as a Binary with no left operand.
+            if (!e->left) {
+                compileExpr(e->right);
+                line = e->feedback.line;
+                if (e->op == MINUS) emit(OP_NEGATE);
+                else emit(OP_NOT);
+                break;
+            }
+
+            compileExpr(e->left);
+            compileExpr(e->right);
+            line = e->feedback.line;
+            switch (e->op) {
+                case PLUS:          emitBinary(OP_ADD, e->op); break;
+                case MINUS:         emitBinary(OP_SUBTRACT, e->op); break;
+                case STAR:          emitBinary(OP_MULTIPLY, e->op); break;
+                case SLASH:         emitBinary(OP_DIVIDE, e->op); break;
+                case EQUAL_EQUAL:   emit(OP_EQUAL); break;
+                case BANG_EQUAL:    emit(OP_NOT_EQUAL); break;
+                case GREATER:       emitBinary(OP_GREATER, e->op); break;
+                case GREATER_EQUAL: emitBinary(OP_GREATER_EQUAL, e->op); break;
+                case LESS:          emitBinary(OP_LESS, e->op); break;
+                case LESS_EQUAL:    emitBinary(OP_LESS_EQUAL, e->op); break;
+                default:
+                    throw std::runtime_error("Unknown or unhandled operator.");
+            }
+            break;
+        }
+        case ExprKind::CALL:
+            emit(OP_NIL);
+            break;
+    }
+}
+
+// --- Scopes ---
+int Compiler::localSlot(int depth, int slot) const {
+    return scopes[scopes.size() - 1 - depth].base + slot;
+}
+
+// --- Emit helpers ---
+void Compiler::emit(uint8_t byte) { chunk.write(byte, line); }
+
+void Compiler::emitIndex(OpCode op, size_t index) {
+    if (index > 0xFFFFFF) throw std::runtime_error("Too many constants in one chunk.");
+    emit(op);
+    emit((index >> 16) & 0xFF);
+    emit((index >> 8) & 0xFF);
+    emit(index & 0xFF);
+}
+
+void Compiler::emitSlot(OpCode op, size_t slot) {
+    emit(op);
+    emit((slot >> 8) & 0xFF);
+    emit(slot & 0xFF);
+}
+
+// Field access: name constant plus a fresh inline cache for this site
+void Compiler::emitField(OpCode op, Value name, int siteLine) {
+    line = siteLine;
+    size_t cache = chunk.caches.size();
+    if (cache > 0xFFFFFF) throw std::runtime_error("Too many field access sites in one chunk.");
+    chunk.caches.emplace_back(op == OP_GET_FIELD ? InlineCache::GET : InlineCache::SET, line);
+    emitIndex(op, stringConstant(name));
+    emit((cache >> 16) & 0xFF);
+    emit((cache >> 8) & 0xFF);
+    emit(cache & 0xFF);
+}
+
+// Arithmetic and relational ops: a fresh type feedback record for this site
+void Compiler::emitBinary(OpCode op, TokenType token) {
+    size_t site = chunk.feedback.size();
+    if (site > 0xFFFFFF) throw std::runtime_error("Too many operator sites in one chunk.");
+    chunk.feedback.emplace_back(token, line);
+    emitIndex(op, site);
+}
+
+size_t Compiler::emitJump(OpCode op) {
+    emitIndex(op, 0);
+    return chunk.code.size() - 3;
+}
+
+// Offsets are relative to the end of the jump instruction
+void Compiler::patchJump(size_t operand) {
+    size_t jump = chunk.code.size() - (operand + 3);
+    if (jump > 0xFFFFFF) throw std::runtime_error("Too much code to jump over.");
+    chunk.code[operand] = (jump >> 16) & 0xFF;
+    chunk.code[operand + 1] = (jump >> 8) & 0xFF;
+    chunk.code[operand + 2] = jump & 0xFF;
+}
+
+void Compiler::emitLoop(size_t loopStart) {
+    size_t jump = chunk.code.size() + 4 - loopStart;
+    if (jump > 0xFFFFFF) throw std::runtime_error("Loop body too large.");
+    emitIndex(OP_LOOP, jump);
+}
+
+size_t Compiler::stringConstant(const Value& str) {
+    auto it = stringConstants.find(str.asHandle());
+    if (it != stringConstants.end()) return it->second;
+    size_t index = chunk.addConstant(str);
+    stringConstants[str.asHandle()] = index;
+    return index;
+}
+
+size_t Compiler::numberConstant(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    auto it = numberConstants.find(bits);
+    if (it != numberConstants.end()) return it->second;
+    size_t index = chunk.addConstant(Value::number(value));
+    numberConstants[bits] = index;
+    return index;
+}
@@ -0,0 +1,69 @@
+#include "GCWorkers.h"
+
+GCWorkerPool::~GCWorkerPool() {
+    stop();
+}
+
+void GCWorkerPool::stop() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : threads) t.join();
+    threads.clear();
+    stopping = false;
+}
+
+void GCWorkerPool::resize(size_t n) {
+    if (n == 0) n = 1;
+    if (n == participants) return;
+    stop();
+    participants = n;
+}
+
+void GCWorkerPool::run(const std::function<void(size_t)>& fn) {
+    if (participants == 1) {
+        fn(0);
+        return;
+    }
+    if (threads.empty()) {
+        for (size_t i = 1; i < participants; i++) threads.emplace_back(&GCWorkerPool::workerLoop, this, i);
+    }
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        job = &fn;
+        pending = threads.size();
+        round++;
+    }
+    wake.notify_all();
+    fn(0);
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return pending == 0; });
+    job = nullptr;
+}
+
+void GCWorkerPool::workerLoop(size_t index) {
+    size_t seen = 0;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        seen = round; // a thread started by run() must not miss that first round
+        if (job) seen--;
+    }
+    for (;;) {
+        const std::function<void(size_t)>* current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || round != seen; });
+            if (stopping) return;
+            seen = round;
+            current = job;
+        }
+        (*current)(index);
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            pending--;
+        }
+        finished.notify_one();
+    }
+}
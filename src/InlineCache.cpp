@@ -0,0 +1,62 @@
+#include "InlineCache.h"
+#include "Isolate.h"
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+
+// Sites are registered on their first miss, so only executed sites are listed
+static std::vector<InlineCache*>& sites() {
+    return Isolate::current().cacheSites;
+}
+
+void InlineCache::addEntry(Entry entry) {
+    if (state == UNINITIALIZED) sites().push_back(this);
+    if (state == MEGAMORPHIC) return;
+    if (count == POLY_MAX) {
+        state = MEGAMORPHIC;
+        count = 0;
+        return;
+    }
+    entries[count++] = entry;
+    state = count == 1 ? MONOMORPHIC : POLYMORPHIC;
+}
+
+Value InlineCache::getMiss(InstanceObject* obj, size_t name) {
+    misses++;
+    Shape* shape = obj->shape;
+    int slot = shape->lookup(name);
+    addEntry({shape, nullptr, slot});
+    return slot >= 0 ? obj->slot(slot) : Value::nil();
+}
+
+void InlineCache::setMiss(InstanceObject* obj, size_t name, const Value& value) {
+    misses++;
+    Shape* shape = obj->shape;
+    int slot = shape->lookup(name);
+    if (slot >= 0) {
+        obj->slot(slot) = value;
+        addEntry({shape, nullptr, slot});
+        return;
+    }
+    Shape* next = shape->addField(name);
+    obj->appendSlot(next, value);
+    addEntry({shape, next, (int)next->slotCount() - 1});
+}
+
+void InlineCache::dumpStats(std::ostream& out) {
+    static const char* states[] = {"uninitialized", "monomorphic", "polymorphic", "megamorphic"};
+    std::vector<InlineCache*> sorted = sites();
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](InlineCache* a, InlineCache* b) { return a->line < b->line; });
+
+    char row[128];
+    out << "Inline cache stats:\n";
+    std::snprintf(row, sizeof row, "%6s  %-4s  %-13s  %7s  %12s  %12s\n", "line", "kind", "state", "shapes", "hits", "misses");
+    out << row;
+    for (InlineCache* ic : sorted) {
+        std::snprintf(row, sizeof row, "%6d  %-4s  %-13s  %7d  %12llu  %12llu\n", ic->line,
+                      ic->kind == GET ? "get" : "set", states[ic->state], ic->count,
+                      (unsigned long long)ic->hits, (unsigned long long)ic->misses);
+        out << row;
+    }
+}
@@ -1,172 +1,304 @@
 #include "Interpreter.h"
+#include "Isolate.h"
+#include <algorithm>
 #include <iostream>
 
 // --- Environment Impl ---
-void Environment::define(std::string name, Value value) {
-    values[name] = value;
+void Environment::define(int slot, Value value) {
+    values[slot] = value;
 }
 
-Value Environment::get(Token name) {
-    if (values.count(name.lexeme)) return values[name.lexeme];
-    if (enclosing) return enclosing->get(name);
-    throw std::runtime_error("Undefined variable '" + name.lexeme + "'.");
+Environment* Environment::ancestor(int depth) {
+    Environment* env = this;
+    for (int i = 0; i < depth; i++) env = env->enclosing;
+    return env;
 }
 
-void Environment::assign(Token name, Value value) {
-    if (values.count(name.lexeme)) {
-        values[name.lexeme] = value;
-        return;
-    }
-    if (enclosing) {
-        enclosing->assign(name, value);
-        return;
+Value Environment::get(int depth, int slot) {
+    return ancestor(depth)->values[slot];
+}
+
+void Environment::assign(int depth, int slot, Value value) {
+    ancestor(depth)->values[slot] = value;
+}
+
+// --- ScopeStack Impl ---
+Value* ScopeStack::push(size_t count) {
+    if (count == 0) return nullptr;
+    if (!chunks.empty() && chunks[current].used + count > chunks[current].capacity) current++;
+    if (current == chunks.size() || chunks[current].capacity < count) {
+        size_t capacity = std::max(CHUNK_SLOTS, count);
+        Chunk chunk{std::unique_ptr<Value[]>(new Value[capacity]), capacity};
+        if (current == chunks.size()) chunks.push_back(std::move(chunk));
+        else chunks[current] = std::move(chunk); // unused above the top, so nothing points into it
     }
-    throw std::runtime_error("Undefined variable '" + name.lexeme + "'.");
+    Chunk& chunk = chunks[current];
+    Value* values = chunk.values.get() + chunk.used;
+    chunk.used += count;
+    // Cleared so the GC never sees a stale handle in a slot not yet defined
+    std::fill(values, values + count, Value::nil());
+    return values;
+}
+
+void ScopeStack::pop(size_t count) {
+    if (count == 0) return;
+    chunks[current].used -= count;
+    if (chunks[current].used == 0 && current > 0) current--;
 }
 
 // --- Interpreter Impl ---
-Interpreter::Interpreter() {
-    globals = new Environment();
-    environment = globals;
+Interpreter::Interpreter(std::ostream& out, std::ostream& err) : heap(Heap::current()), stats(Isolate::current().stats), out(out), err(err) {
+    heap.addRoots(this);
+}
+
+Interpreter::~Interpreter() {
+    heap.removeRoots(this);
 }
 
-void Interpreter::interpret(const std::vector<std::shared_ptr<Stmt>>& statements) {
+bool Interpreter::interpret(const std::vector<Stmt*>& statements) {
     try {
-        for (const auto& stmt : statements) {
+        if (shadow) shadow->enter();
+        for (Stmt* stmt : statements) {
             execute(stmt);
         }
+        if (shadow) shadow->leave();
+        return true;
     } catch (std::runtime_error& e) {
-        std::cerr << "Runtime Error: " << e.what() << "\n";
+        err << "Runtime Error: " << e.what() << "\n";
+        if (shadow) shadow->clear();
+        return false;
     }
 }
 
-// Trigger GC using current environment as Root
-void Interpreter::triggerGC() {
-    // 1. Mark Roots
+// Roots are the globals, the current environment chain and any
+// intermediates in flight
+void Interpreter::markRoots() {
+    for (auto& val : globals) heap.mark(val);
     Environment* current = environment;
     while(current != nullptr) {
-        for(auto& pair : current->values) {
-            Heap::mark(pair.second);
+        for (size_t i = 0; i < current->size; i++) {
+            heap.mark(current->values[i]);
         }
         current = current->enclosing;
     }
-    // 2. Sweep
-    Heap::sweep();
+    for (auto& val : tempRoots) heap.mark(val);
 }
 
-void Interpreter::execute(std::shared_ptr<Stmt> stmt) {
-    if (auto s = std::dynamic_pointer_cast<PrintStmt>(stmt)) {
-        Value val = evaluate(s->expression);
-        std::cout << val.toString() << "\n";
-    }
-    else if (auto s = std::dynamic_pointer_cast<VarStmt>(stmt)) {
-        Value val = {Value::NIL};
-        if (s->initializer) val = evaluate(s->initializer);
-        environment->define(s->name.lexeme, val);
-    }
-    else if (auto s = std::dynamic_pointer_cast<ClassStmt>(stmt)) {
-        classes[s->name.lexeme] = s;
-    }
-    else if (auto s = std::dynamic_pointer_cast<Block>(stmt)) {
-        executeBlock(s->statements, new Environment(environment));
+void Interpreter::execute(Stmt* stmt) {
+    JLITE_COUNT(stats.stmts[size_t(stmt->kind)]++);
+    if (shadow) shadow->at(stmt->line);
+    switch (stmt->kind) {
+        case StmtKind::PRINT: {
+            Value val = evaluate(static_cast<PrintStmt*>(stmt)->expression);
+            out << val.toString() << "\n";
+            break;
+        }
+        case StmtKind::EXPRESSION:
+            evaluate(static_cast<ExpressionStmt*>(stmt)->expression);
+            break;
+        case StmtKind::VAR: {
+            auto* s = static_cast<VarStmt*>(stmt);
+            Value val = Value::nil();
+            if (s->initializer) val = evaluate(s->initializer);
+            if (environment) {
+                environment->define(s->slot, val);
+            } else {
+                // Globals grow as they are declared
+                if (s->slot >= (int)globals.size()) globals.resize(s->slot + 1);
+                globals[s->slot] = val;
+            }
+            break;
+        }
+        case StmtKind::CLASS: {
+            auto* s = static_cast<ClassStmt*>(stmt);
+            classes[s->name.asHandle()] = s;
+            break;
+        }
+        case StmtKind::WHILE: {
+            auto* s = static_cast<WhileStmt*>(stmt);
+            if (!shadow) {
+                while (evaluate(s->condition).isTruthy()) execute(s->body);
+                break;
+            }
+            // The body runs a level down, leaving the condition on the loop's line
+            while (evaluate(s->condition).isTruthy()) {
+                shadow->enter();
+                execute(s->body);
+                shadow->leave();
+            }
+            break;
+        }
+        case StmtKind::BLOCK: {
+            auto* s = static_cast<Block*>(stmt);
+            executeBlock(s->statements, s->slotCount);
+            break;
+        }
+        case StmtKind::FUNCTION:
+            // ... Add If, Function implementations here
+            break;
     }
-    // ... Add If, While, Function implementations here
 }
 
-void Interpreter::executeBlock(const std::vector<std::shared_ptr<Stmt>>& statements, Environment* env) {
+// There are no closures yet, so nothing can hold on to a scope after its
+// block exits and the scope is freed right here. A scope captured by a
+// closure will have to move to the heap instead.
+void Interpreter::executeBlock(const NodeList<Stmt>& statements, int slotCount) {
+    Environment env(environment, scopes.push(slotCount), slotCount);
     Environment* previous = environment;
-    environment = env;
+    environment = &env;
     try {
-        for (const auto& stmt : statements) execute(stmt);
+        for (Stmt* stmt : statements) execute(stmt);
     } catch(...) {
         environment = previous;
+        scopes.pop(slotCount);
         throw;
     }
     environment = previous;
-    // Don't delete env here in a real language without proper memory management for Envs, 
-    // but for this simple GC demo, we let C++ handle env pointer, but values are managed by Heap.
-}
-
-Value Interpreter::evaluate(std::shared_ptr<Expr> expr) {
-    if (auto e = std::dynamic_pointer_cast<Literal>(expr)) {
-        if (std::holds_alternative<double>(e->value)) 
-            return {Value::NUMBER, std::get<double>(e->value)};
-        if (std::holds_alternative<std::string>(e->value)) 
-            return {Value::STRING, std::get<std::string>(e->value)};
-        if (std::holds_alternative<bool>(e->value)) // ADD THIS
-            return {Value::BOOL, std::get<bool>(e->value)};
-        return {Value::NIL};
+    scopes.pop(slotCount);
+}
+
+Value Interpreter::evaluate(Expr* expr) {
+    JLITE_COUNT(stats.exprs[size_t(expr->kind)]++);
+    switch (expr->kind) {
+        case ExprKind::LITERAL:
+            return static_cast<Literal*>(expr)->value;
+        case ExprKind::VARIABLE: {
+            auto* e = static_cast<Variable*>(expr);
+            if (e->depth < 0) return globals[e->slot];
+            JLITE_COUNT(stats.envLookups++, stats.envHops += e->depth);
+            return environment->get(e->depth, e->slot);
+        }
+        case ExprKind::ASSIGN: {
+            auto* e = static_cast<Assign*>(expr);
+            Value val = evaluate(e->value);
+            if (e->depth < 0) {
+                globals[e->slot] = val;
+            } else {
+                JLITE_COUNT(stats.envLookups++, stats.envHops += e->depth);
+                environment->assign(e->depth, e->slot, val);
+            }
+            return val;
+        }
+        case ExprKind::NEW: {
+            auto* e = static_cast<New*>(expr);
+            // Look up class definition
+            if (classes.find(e->className.asHandle()) == classes.end())
+                throw std::runtime_error("Unknown class " + std::string(e->className.asString()));
+
+            // Allocate Instance (may collect first)
+            size_t addr = heap.allocate<InstanceObject>(Shape::root(e->className.asHandle()));
+
+            return Value::instance(addr);
+        }
+        case ExprKind::GET: {
+            auto* e = static_cast<Get*>(expr);
+            Value objVal = evaluate(e->object);
+            if (!objVal.isInstance()) throw std::runtime_error("Only instances have properties.");
+
+            HeapObject* ho = heap.get(objVal.asHandle());
+            InstanceObject* io = static_cast<InstanceObject*>(ho);
+
+            return e->ic.get(io, e->name.asHandle());
+        }
+        case ExprKind::SET: {
+            auto* e = static_cast<Set*>(expr);
+            Value objVal = evaluate(e->object);
+            if (!objVal.isInstance()) throw std::runtime_error("Only instances have fields.");
+
+            tempRoots.push_back(objVal);
+            Value val = evaluate(e->value);
+            tempRoots.pop_back();
+            HeapObject* ho = heap.get(objVal.asHandle());
+            InstanceObject* io = static_cast<InstanceObject*>(ho);
+
+            e->ic.set(io, e->name.asHandle(), val);
+            return val;
+        }
+        case ExprKind::BINARY:
+            return evaluateBinary(static_cast<Binary*>(expr));
+        case ExprKind::CALL:
+            break;
     }
-    else if (auto e = std::dynamic_pointer_cast<Variable>(expr)) {
-        return environment->get(e->name);
+    return Value::nil();
+}
+
+// An arithmetic or relational operator applied to two numbers. Only called
+// for operators that BinaryFeedback::quickens().
+static inline Value numeric(TokenType op, double a, double b) {
+    switch (op) {
+        case PLUS:          return Value::number(a + b);
+        case MINUS:         return Value::number(a - b);
+        case STAR:          return Value::number(a * b);
+        case SLASH:         return Value::number(a / b);
+        case GREATER:       return Value::boolean(a > b);
+        case GREATER_EQUAL: return Value::boolean(a >= b);
+        case LESS:          return Value::boolean(a < b);
+        default:            return Value::boolean(a <= b);
     }
-    else if (auto e = std::dynamic_pointer_cast<Assign>(expr)) {
-        Value val = evaluate(e->value);
-        environment->assign(e->name, val);
-        return val;
+}
+
+// The unspecialized semantics of every binary operator
+static Value binaryOperator(TokenType op, const Value& left, const Value& right) {
+    if (op == PLUS) {
+        if (left.isNumber() && right.isNumber())
+            return Value::number(left.asNumber() + right.asNumber());
+        if (left.isString() && right.isString())
+            return Value::string(std::string(left.asString()) + std::string(right.asString()));
+        throw std::runtime_error("Operands must be two numbers or two strings.");
     }
-    else if (auto e = std::dynamic_pointer_cast<New>(expr)) {
-        // Look up class definition
-        if (classes.find(e->className.lexeme) == classes.end()) 
-            throw std::runtime_error("Unknown class " + e->className.lexeme);
-        
-        // Allocate Instance
-        InstanceObject* obj = new InstanceObject(e->className.lexeme);
-        size_t addr = Heap::allocate(obj);
-
-        // Check GC Threshold
-        if (Heap::objects.size() > 5) triggerGC();
-
-        return {Value::INSTANCE, addr};
+    if (op == EQUAL_EQUAL) return Value::boolean(left == right);
+    if (op == BANG_EQUAL) return Value::boolean(!(left == right));
+
+    if (!BinaryFeedback::quickens(op)) throw std::runtime_error("Unknown or unhandled operator.");
+    if (!left.isNumber() || !right.isNumber())
+        throw std::runtime_error("Operands must be numbers.");
+    return numeric(op, left.asNumber(), right.asNumber());
+}
+
+Value Interpreter::evaluateBinary(Binary* e) {
+    // Unary operators are parsed as a Binary without a left operand
+    if (!e->left) {
+        Value right = evaluate(e->right);
+        if (e->op == BANG) return Value::boolean(!right.isTruthy());
+        if (!right.isNumber()) throw std::runtime_error("Operand must be a number.");
+        return Value::number(-right.asNumber());
     }
-    else if (auto e = std::dynamic_pointer_cast<Get>(expr)) {
-        Value objVal = evaluate(e->object);
-        if (objVal.type != Value::INSTANCE) throw std::runtime_error("Only instances have properties.");
-        
-        HeapObject* ho = Heap::get(std::get<size_t>(objVal.as));
-        InstanceObject* io = dynamic_cast<InstanceObject*>(ho);
-        
-        if (io->fields.count(e->name.lexeme)) {
-            return io->fields[e->name.lexeme];
+
+    BinaryFeedback& site = e->feedback;
+    Value left = evaluate(e->left);
+
+    // Number-specialized site: a number needs no GC root while the right
+    // operand runs, and the operator skips the generic type dispatch
+    if (site.state == BinaryFeedback::NUMBER && left.isNumber()) {
+        Value right = evaluate(e->right);
+        if (right.isNumber()) {
+            site.hits++;
+            return numeric(e->op, left.asNumber(), right.asNumber());
         }
-        return {Value::NIL};
+        site.deoptimize();
+        return binaryOperator(e->op, left, right);
     }
-    else if (auto e = std::dynamic_pointer_cast<Set>(expr)) {
-        Value objVal = evaluate(e->object);
-        if (objVal.type != Value::INSTANCE) throw std::runtime_error("Only instances have fields.");
-        
-        Value val = evaluate(e->value);
-        HeapObject* ho = Heap::get(std::get<size_t>(objVal.as));
-        InstanceObject* io = dynamic_cast<InstanceObject*>(ho);
-        
-        io->fields[e->name.lexeme] = val;
-        return val;
-    } 
-    // Add this inside Interpreter::evaluate logic
-    else if (auto e = std::dynamic_pointer_cast<Binary>(expr)) {
-        Value left = evaluate(e->left);
-        Value right = evaluate(e->right);
 
-        switch (e->op.type) {
-            case PLUS:
-                if (left.type == Value::NUMBER && right.type == Value::NUMBER)
-                    return {Value::NUMBER, std::get<double>(left.as) + std::get<double>(right.as)};
-                if (left.type == Value::STRING && right.type == Value::STRING)
-                    return {Value::STRING, std::get<std::string>(left.as) + std::get<std::string>(right.as)};
-                break;
-            case MINUS:
-                return {Value::NUMBER, std::get<double>(left.as) - std::get<double>(right.as)};
-            case STAR:
-                return {Value::NUMBER, std::get<double>(left.as) * std::get<double>(right.as)};
-            case SLASH:
-                return {Value::NUMBER, std::get<double>(left.as) / std::get<double>(right.as)};
-            case EQUAL_EQUAL:
-                return {Value::BOOL, left.as == right.as};
-            // Add other comparisons as needed...
-            default:
-                throw std::runtime_error("Unknown or unhandled operator.");
-        }
+    tempRoots.push_back(left);
+    Value right = evaluate(e->right);
+    tempRoots.pop_back();
+
+    switch (site.state) {
+        case BinaryFeedback::UNINITIALIZED:
+            site.specialize(left, right);
+            break;
+        case BinaryFeedback::NUMBER:
+            site.deoptimize();
+            break;
+        case BinaryFeedback::STRING:
+            if (left.isString() && right.isString()) {
+                site.hits++;
+                return Value::string(std::string(left.asString()) + std::string(right.asString()));
+            }
+            site.deoptimize();
+            break;
+        case BinaryFeedback::GENERIC:
+            break;
     }
-    // ... Add Binary, Unary logic here (omitted for space, standard math logic)
-    return {Value::NIL};
-}
\ No newline at end of file
+    return binaryOperator(e->op, left, right);
+}
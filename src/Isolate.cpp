@@ -0,0 +1,17 @@
+#include "Isolate.h"
+
+// Both pointers are constant-initialized, so reading them needs no
+// thread_local init guard
+static Isolate defaultIsolate;
+thread_local Isolate* Isolate::active = &defaultIsolate;
+thread_local Heap* Heap::active = &defaultIsolate.heap;
+
+Isolate::Scope::Scope(Isolate& isolate) : previous(active) {
+    active = &isolate;
+    Heap::active = &isolate.heap;
+}
+
+Isolate::Scope::~Scope() {
+    active = previous;
+    Heap::active = &previous->heap;
+}
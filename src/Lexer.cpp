@@ -1,21 +1,77 @@
 #include "Lexer.h"
 #include <iostream>
 
-std::unordered_map<std::string, TokenType> Lexer::keywords = {
+// Keywords are found with a perfect hash of length, first and last byte,
+// checked for collisions at compile time. Any other identifier costs one
+// hash and at most one comparison.
+namespace {
+
+struct Keyword {
+    std::string_view text;
+    TokenType type = IDENTIFIER;
+};
+
+constexpr Keyword KEYWORDS[] = {
     {"class", CLASS}, {"else", ELSE}, {"false", FALSE},
     {"if", IF}, {"null", NIL}, {"print", PRINT},
     {"return", RETURN}, {"super", SUPER}, {"this", THIS},
     {"true", TRUE}, {"var", VAR}, {"while", WHILE}, {"new", NEW}
 };
+constexpr size_t KEYWORD_SLOTS = 32;
+constexpr size_t MIN_KEYWORD = 2, MAX_KEYWORD = 6;
 
-Lexer::Lexer(std::string source) : source(source) {}
+constexpr size_t keywordHash(std::string_view s) {
+    return (s.size() + 3 * (unsigned char)s.front() + (unsigned char)s.back()) % KEYWORD_SLOTS;
+}
 
-std::vector<Token> Lexer::scanTokens() {
+struct KeywordTable {
+    Keyword slots[KEYWORD_SLOTS] = {};
+    bool perfect = true;
+};
+
+constexpr KeywordTable buildKeywordTable() {
+    KeywordTable table;
+    for (const Keyword& k : KEYWORDS) {
+        Keyword& slot = table.slots[keywordHash(k.text)];
+        if (!slot.text.empty()) table.perfect = false;
+        slot = k;
+    }
+    return table;
+}
+
+constexpr KeywordTable keywordTable = buildKeywordTable();
+static_assert(keywordTable.perfect, "keyword hash collides; change its multipliers");
+
+TokenType keywordType(std::string_view text) {
+    if (text.size() < MIN_KEYWORD || text.size() > MAX_KEYWORD) return IDENTIFIER;
+    const Keyword& k = keywordTable.slots[keywordHash(text)];
+    return k.text == text ? k.type : IDENTIFIER;
+}
+
+} // namespace
+
+Lexer::Lexer(std::string_view source, const scan::Kernels& kernels) : source(source), kernels(kernels) {}
+
+// Whitespace and comments produce no token, so keep scanning until one does
+Token Lexer::next() {
     while (!isAtEnd()) {
         start = current;
+        haveToken = false;
         scanToken();
+        if (haveToken) return scanned;
     }
-    tokens.push_back(Token(END_OF_FILE, "", std::monostate{}, line));
+    return Token(END_OF_FILE, "", Value::nil(), line);
+}
+
+std::vector<Token> Lexer::scanTokens() {
+    // Typical source has a token every four to six bytes; guessing high
+    // saves the regrowth copies on big scripts, and pages of the guess
+    // that are never written are never touched
+    std::vector<Token> tokens;
+    tokens.reserve(source.size() / 4 + 1);
+    do {
+        tokens.push_back(next());
+    } while (tokens.back().type != END_OF_FILE);
     return tokens;
 }
 
@@ -37,16 +93,21 @@ void Lexer::scanToken() {
         case '<': addToken(match('=') ? LESS_EQUAL : LESS); break;
         case '>': addToken(match('=') ? GREATER_EQUAL : GREATER); break;
         case '/': 
-            if (match('/')) while (peek() != '\n' && !isAtEnd()) advance();
+            if (match('/')) moveTo(kernels.lineEnd(cursor(), end()));
             else addToken(SLASH);
             break;
-        case ' ': case '\r': case '\t': break;
-        case '\n': line++; break;
+        case '\n': line++; // fall through
+        case ' ': case '\r': case '\t':
+            moveTo(kernels.whitespace(cursor(), end(), line));
+            break;
         case '"': string(); break;
         default:
-            if (isdigit(c)) number();
-            else if (isalpha(c) || c == '_') identifier();
-            else std::cerr << "Unexpected character at line " << line << "\n";
+            if (scan::isDigit(c)) number();
+            else if (scan::isAlpha(c)) identifier();
+            else {
+                *diagnostics << "Unexpected character at line " << line << "\n";
+                errors++;
+            }
             break;
     }
 }
@@ -72,39 +133,44 @@ bool Lexer::match(char expected) {
     return true;
 }
 
-void Lexer::addToken(TokenType type) { addToken(type, {}); }
+void Lexer::addToken(TokenType type) { addToken(type, Value::nil()); }
 
-void Lexer::addToken(TokenType type, std::variant<std::monostate, double, std::string, bool> literal) {
-    std::string text = source.substr(start, current - start);
-    tokens.push_back(Token(type, text, literal, line));
+void Lexer::addToken(TokenType type, Value literal) {
+    scanned = Token(type, source.substr(start, current - start), literal, line);
+    haveToken = true;
 }
 
 void Lexer::identifier() {
-    while (isalnum(peek()) || peek() == '_') advance();
-    std::string text = source.substr(start, current - start);
-    TokenType type = keywords.count(text) ? keywords[text] : IDENTIFIER;
-    addToken(type);
+    moveTo(kernels.identifier(cursor(), end()));
+    std::string_view text = source.substr(start, current - start);
+    TokenType type = keywordType(text);
+    if (type != IDENTIFIER) {
+        addToken(type);
+        return;
+    }
+    // Names are interned once here so later passes can compare and hash
+    // them by handle. Pinned: the AST and compiled code refer to them.
+    Value name = Value::string(text);
+    Heap::current().pin(name);
+    addToken(IDENTIFIER, name);
 }
 
 void Lexer::number() {
-    while (isdigit(peek())) advance();
-    if (peek() == '.' && isdigit(peekNext())) {
+    moveTo(kernels.digits(cursor(), end()));
+    if (peek() == '.' && scan::isDigit(peekNext())) {
         advance();
-        while (isdigit(peek())) advance();
+        moveTo(kernels.digits(cursor(), end()));
     }
-    addToken(NUMBER, std::stod(source.substr(start, current - start)));
+    addToken(NUMBER);
 }
 
 void Lexer::string() {
-    while (peek() != '"' && !isAtEnd()) {
-        if (peek() == '\n') line++;
-        advance();
-    }
+    moveTo(kernels.stringEnd(cursor(), end(), line));
     if (isAtEnd()) {
-        std::cerr << "Unterminated string at line " << line << "\n";
+        *diagnostics << "Unterminated string at line " << line << "\n";
+        errors++;
         return;
     }
     advance(); // The closing "
-    std::string value = source.substr(start + 1, current - start - 2);
-    addToken(STRING, value);
+    addToken(STRING);
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "Optimizer.h"
+#include <cmath>
+#include <string>
+
+static bool isLiteral(Expr* e) { return e && e->kind == ExprKind::LITERAL; }
+static const Value& literal(Expr* e) { return static_cast<Literal*>(e)->value; }
+static bool isNumberLiteral(Expr* e, double n) {
+    return isLiteral(e) && literal(e).isNumber() && literal(e).asNumber() == n;
+}
+
+// True if the expression can only produce a number (when it doesn't fail):
+// number literals, -, * and /, and + over two such operands
+static bool isNumeric(Expr* e) {
+    if (isLiteral(e)) return literal(e).isNumber();
+    if (e->kind != ExprKind::BINARY) return false;
+    auto* b = static_cast<Binary*>(e);
+    if (b->op == MINUS || b->op == STAR || b->op == SLASH) return true;
+    return b->op == PLUS && b->left && isNumeric(b->left) && isNumeric(b->right);
+}
+
+void Optimizer::optimize(std::vector<Stmt*>& statements) {
+    for (Stmt* stmt : statements) optimizeStmt(stmt);
+}
+
+void Optimizer::optimizeStmt(Stmt* stmt) {
+    switch (stmt->kind) {
+        case StmtKind::PRINT: {
+            auto* s = static_cast<PrintStmt*>(stmt);
+            s->expression = optimizeExpr(s->expression);
+            break;
+        }
+        case StmtKind::EXPRESSION: {
+            auto* s = static_cast<ExpressionStmt*>(stmt);
+            s->expression = optimizeExpr(s->expression);
+            break;
+        }
+        case StmtKind::VAR: {
+            auto* s = static_cast<VarStmt*>(stmt);
+            if (s->initializer) s->initializer = optimizeExpr(s->initializer);
+            break;
+        }
+        case StmtKind::WHILE: {
+            auto* s = static_cast<WhileStmt*>(stmt);
+            s->condition = optimizeExpr(s->condition);
+            optimizeStmt(s->body);
+            break;
+        }
+        case StmtKind::BLOCK:
+            for (Stmt* inner : static_cast<Block*>(stmt)->statements) optimizeStmt(inner);
+            break;
+        case StmtKind::FUNCTION:
+        case StmtKind::CLASS:
+            break;
+    }
+}
+
+Expr* Optimizer::optimizeExpr(Expr* expr) {
+    switch (expr->kind) {
+        case ExprKind::ASSIGN: {
+            auto* e = static_cast<Assign*>(expr);
+            e->value = optimizeExpr(e->value);
+            break;
+        }
+        case ExprKind::GET: {
+            auto* e = static_cast<Get*>(expr);
+            e->object = optimizeExpr(e->object);
+            break;
+        }
+        case ExprKind::SET: {
+            auto* e = static_cast<Set*>(expr);
+            e->object = optimizeExpr(e->object);
+            e->value = optimizeExpr(e->value);
+            break;
+        }
+        case ExprKind::CALL: {
+            auto* e = static_cast<Call*>(expr);
+            e->callee = optimizeExpr(e->callee);
+            for (Expr*& arg : e->arguments) arg = optimizeExpr(arg);
+            break;
+        }
+        case ExprKind::BINARY: {
+            // Children first, so folding works bottom-up through nested operators
+            auto* e = static_cast<Binary*>(expr);
+            if (e->left) e->left = optimizeExpr(e->left);
+            e->right = optimizeExpr(e->right);
+            if (Expr* folded = foldBinary(e)) return folded;
+            return simplifyBinary(e);
+        }
+        case ExprKind::LITERAL:
+        case ExprKind::VARIABLE:
+        case ExprKind::NEW:
+            break;
+    }
+    return expr;
+}
+
+// Evaluates the operator here, exactly as both engines would, if all its
+// operands are literals and the operation cannot fail. Null if it can't.
+Expr* Optimizer::foldBinary(Binary* e) {
+    if (!isLiteral(e->right) || (e->left && !isLiteral(e->left))) return nullptr;
+    const Value& right = literal(e->right);
+    Value result;
+
+    if (!e->left) {
+        if (e->op == BANG) result = Value::boolean(!right.isTruthy());
+        else if (right.isNumber()) result = Value::number(-right.asNumber());
+        else return nullptr;
+    } else {
+        const Value& left = literal(e->left);
+        if (e->op == EQUAL_EQUAL) {
+            result = Value::boolean(left == right);
+        } else if (e->op == BANG_EQUAL) {
+            result = Value::boolean(!(left == right));
+        } else if (e->op == PLUS && left.isString() && right.isString()) {
+            // Pinned like every other string literal in the AST
+            result = Value::string(std::string(left.asString()) + std::string(right.asString()));
+            Heap::current().pin(result);
+        } else if (left.isNumber() && right.isNumber()) {
+            double a = left.asNumber(), b = right.asNumber();
+            switch (e->op) {
+                case PLUS:          result = Value::number(a + b); break;
+                case MINUS:         result = Value::number(a - b); break;
+                case STAR:          result = Value::number(a * b); break;
+                case SLASH:         result = Value::number(a / b); break;
+                case GREATER:       result = Value::boolean(a > b); break;
+                case GREATER_EQUAL: result = Value::boolean(a >= b); break;
+                case LESS:          result = Value::boolean(a < b); break;
+                case LESS_EQUAL:    result = Value::boolean(a <= b); break;
+                default:            return nullptr;
+            }
+        } else {
+            return nullptr; // a type error; the runtime reports it
+        }
+    }
+    folded++;
+    return ast.make<Literal>(result);
+}
+
+// x * 1, 1 * x, x / 1, x - 0 and -(-x) are x for every number x, including
+// NaN and -0. x + 0 is not (-0 + 0 is +0), so it stays. The other operand
+// must be known to be a number: for anything else the operator throws.
+Expr* Optimizer::simplifyBinary(Binary* e) {
+    Expr* result = nullptr;
+    if (!e->left) {
+        if (e->op == MINUS && e->right->kind == ExprKind::BINARY) {
+            auto* inner = static_cast<Binary*>(e->right);
+            if (!inner->left && inner->op == MINUS && isNumeric(inner->right)) result = inner->right;
+        }
+    } else if (e->op == STAR) {
+        if (isNumberLiteral(e->right, 1) && isNumeric(e->left)) result = e->left;
+        else if (isNumberLiteral(e->left, 1) && isNumeric(e->right)) result = e->right;
+    } else if (e->op == SLASH) {
+        if (isNumberLiteral(e->right, 1) && isNumeric(e->left)) result = e->left;
+    } else if (e->op == MINUS) {
+        if (isLiteral(e->right) && literal(e->right).isNumber() && literal(e->right).asNumber() == 0 &&
+            !std::signbit(literal(e->right).asNumber()) && isNumeric(e->left))
+            result = e->left;
+    }
+    if (!result) return e;
+    simplified++;
+    return result;
+}
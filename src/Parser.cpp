@@ -1,130 +1,169 @@
 #include "Parser.h"
+#include <charconv>
 
-std::vector<std::shared_ptr<Stmt>> Parser::parse() {
-    std::vector<std::shared_ptr<Stmt>> statements;
+std::vector<Stmt*> Parser::parse() {
+    std::vector<Stmt*> statements;
     while (!isAtEnd()) {
         statements.push_back(declaration());
     }
     return statements;
 }
 
-std::shared_ptr<Stmt> Parser::declaration() {
+Stmt* Parser::parseNext() {
+    if (isAtEnd()) return nullptr;
+    return declaration();
+}
+
+Stmt* Parser::declaration() {
     if (match(CLASS)) return classDeclaration();
     if (match(VAR)) return varDeclaration();
     return statement();
 }
 
-std::shared_ptr<Stmt> Parser::classDeclaration() {
+Stmt* Parser::classDeclaration() {
     Token name = consume(IDENTIFIER, "Expect class name.");
     consume(LEFT_BRACE, "Expect '{' before class body.");
-    std::vector<std::shared_ptr<Function>> methods;
+    NodeList<Function> methods;
     while (!check(RIGHT_BRACE) && !isAtEnd()) {
         // Simple logic: every identifier in a class is treated as a method for now
         // A full impl would parse parameters and bodies
     }
     consume(RIGHT_BRACE, "Expect '}' after class body.");
-    return std::make_shared<ClassStmt>(name, methods);
+    return ast.make<ClassStmt>(name, methods);
 }
 
-std::shared_ptr<Stmt> Parser::varDeclaration() {
+Stmt* Parser::varDeclaration() {
     Token name = consume(IDENTIFIER, "Expect variable name.");
-    std::shared_ptr<Expr> initializer = nullptr;
+    Expr* initializer = nullptr;
     if (match(EQUAL)) initializer = expression();
     consume(SEMICOLON, "Expect ';' after variable declaration.");
-    return std::make_shared<VarStmt>(name, initializer);
+    return ast.make<VarStmt>(name, initializer);
 }
 
-std::shared_ptr<Stmt> Parser::statement() {
+Stmt* Parser::statement() {
     if (match(PRINT)) return printStatement();
+    if (match(WHILE)) return whileStatement();
+    if (match(LEFT_BRACE)) {
+        int line = previous().line;
+        return ast.make<Block>(block(), line);
+    }
     return expressionStatement();
 }
 
-std::shared_ptr<Stmt> Parser::printStatement() {
-    std::shared_ptr<Expr> value = expression();
+Stmt* Parser::printStatement() {
+    int line = previous().line;
+    Expr* value = expression();
     consume(SEMICOLON, "Expect ';' after value.");
-    return std::make_shared<PrintStmt>(value);
+    return ast.make<PrintStmt>(value, line);
+}
+
+Stmt* Parser::whileStatement() {
+    int line = previous().line;
+    consume(LEFT_PAREN, "Expect '(' after 'while'.");
+    Expr* condition = expression();
+    consume(RIGHT_PAREN, "Expect ')' after condition.");
+    Stmt* body = statement();
+    return ast.make<WhileStmt>(condition, body, line);
 }
 
-std::shared_ptr<Stmt> Parser::expressionStatement() {
-    std::shared_ptr<Expr> expr = expression();
+Stmt* Parser::expressionStatement() {
+    int line = peek().line;
+    Expr* expr = expression();
     consume(SEMICOLON, "Expect ';' after expression.");
-    return std::make_shared<ExpressionStmt>(expr);
+    return ast.make<ExpressionStmt>(expr, line);
+}
+
+// Nested blocks push their statements onto one shared stack; each block
+// copies its own run into the arena and pops it on the way out
+NodeList<Stmt> Parser::block() {
+    size_t base = pending.size();
+    while (!check(RIGHT_BRACE) && !isAtEnd()) {
+        Stmt* stmt = declaration();
+        pending.push_back(stmt);
+    }
+    consume(RIGHT_BRACE, "Expect '}' after block.");
+    NodeList<Stmt> statements;
+    statements.count = uint32_t(pending.size() - base);
+    statements.items = ast.copy(pending.data() + base, statements.count);
+    pending.resize(base);
+    return statements;
 }
 
-std::shared_ptr<Expr> Parser::expression() {
+Expr* Parser::expression() {
     return assignment();
 }
 
-std::shared_ptr<Expr> Parser::assignment() {
-    std::shared_ptr<Expr> expr = equality();
+Expr* Parser::assignment() {
+    Expr* expr = equality();
     if (match(EQUAL)) {
-        Token equals = previous();
-        std::shared_ptr<Expr> value = assignment();
-        if (auto v = std::dynamic_pointer_cast<Variable>(expr)) {
-            return std::make_shared<Assign>(v->name, value);
-        } else if (auto g = std::dynamic_pointer_cast<Get>(expr)) {
-            return std::make_shared<Set>(g->object, g->name, value);
+        Expr* value = assignment();
+        if (expr->kind == ExprKind::VARIABLE) {
+            auto* v = static_cast<Variable*>(expr);
+            return ast.make<Assign>(v->name, v->line, value);
+        } else if (expr->kind == ExprKind::GET) {
+            auto* g = static_cast<Get*>(expr);
+            return ast.make<Set>(g->object, g->name, g->ic.line, value);
         }
         throw std::runtime_error("Invalid assignment target.");
     }
     return expr;
 }
 
-std::shared_ptr<Expr> Parser::equality() {
-    std::shared_ptr<Expr> expr = comparison();
+Expr* Parser::equality() {
+    Expr* expr = comparison();
     while (match({BANG_EQUAL, EQUAL_EQUAL})) {
         Token op = previous();
-        std::shared_ptr<Expr> right = comparison();
-        expr = std::make_shared<Binary>(expr, op, right);
+        Expr* right = comparison();
+        expr = ast.make<Binary>(expr, op, right);
     }
     return expr;
 }
 
-std::shared_ptr<Expr> Parser::comparison() {
-    std::shared_ptr<Expr> expr = term();
+Expr* Parser::comparison() {
+    Expr* expr = term();
     while (match({GREATER, GREATER_EQUAL, LESS, LESS_EQUAL})) {
         Token op = previous();
-        std::shared_ptr<Expr> right = term();
-        expr = std::make_shared<Binary>(expr, op, right);
+        Expr* right = term();
+        expr = ast.make<Binary>(expr, op, right);
     }
     return expr;
 }
 
-std::shared_ptr<Expr> Parser::term() {
-    std::shared_ptr<Expr> expr = factor();
+Expr* Parser::term() {
+    Expr* expr = factor();
     while (match({MINUS, PLUS})) {
         Token op = previous();
-        std::shared_ptr<Expr> right = factor();
-        expr = std::make_shared<Binary>(expr, op, right);
+        Expr* right = factor();
+        expr = ast.make<Binary>(expr, op, right);
     }
     return expr;
 }
 
-std::shared_ptr<Expr> Parser::factor() {
-    std::shared_ptr<Expr> expr = unary();
+Expr* Parser::factor() {
+    Expr* expr = unary();
     while (match({SLASH, STAR})) {
         Token op = previous();
-        std::shared_ptr<Expr> right = unary();
-        expr = std::make_shared<Binary>(expr, op, right);
+        Expr* right = unary();
+        expr = ast.make<Binary>(expr, op, right);
     }
     return expr;
 }
 
-std::shared_ptr<Expr> Parser::unary() {
+Expr* Parser::unary() {
     if (match({BANG, MINUS})) {
         Token op = previous();
-        std::shared_ptr<Expr> right = unary();
-        return std::make_shared<Binary>(nullptr, op, right); // Simplified
+        Expr* right = unary();
+        return ast.make<Binary>(nullptr, op, right); // Simplified
     }
     return call();
 }
 
-std::shared_ptr<Expr> Parser::call() {
-    std::shared_ptr<Expr> expr = primary();
+Expr* Parser::call() {
+    Expr* expr = primary();
     while (true) {
         if (match(DOT)) {
             Token name = consume(IDENTIFIER, "Expect property name after '.'.");
-            expr = std::make_shared<Get>(expr, name);
+            expr = ast.make<Get>(expr, name);
         } else {
             break;
         }
@@ -132,38 +171,61 @@ std::shared_ptr<Expr> Parser::call() {
     return expr;
 }
 
-std::shared_ptr<Expr> Parser::primary() {
-    if (match(FALSE)) return std::make_shared<Literal>(false);
-    if (match(TRUE)) return std::make_shared<Literal>(true);
-    if (match(NIL)) return std::make_shared<Literal>(std::monostate{});
-    if (match(NUMBER) || match(STRING)) return std::make_shared<Literal>(previous().literal);
+Expr* Parser::primary() {
+    if (match(FALSE)) return ast.make<Literal>(Value::boolean(false));
+    if (match(TRUE)) return ast.make<Literal>(Value::boolean(true));
+    if (match(NIL)) return ast.make<Literal>(Value::nil());
+    if (match(NUMBER)) return ast.make<Literal>(numberLiteral(previous()));
+    if (match(STRING)) return ast.make<Literal>(stringLiteral(previous()));
     
     if (match(NEW)) {
         Token name = consume(IDENTIFIER, "Expect class name.");
         consume(LEFT_PAREN, "Expect '(' after class name.");
         consume(RIGHT_PAREN, "Expect ')' after arguments.");
-        return std::make_shared<New>(name);
+        return ast.make<New>(name);
     }
 
-    if (match(IDENTIFIER)) return std::make_shared<Variable>(previous());
+    if (match(IDENTIFIER)) return ast.make<Variable>(previous());
 
     throw std::runtime_error("Expect expression.");
 }
 
+// Literal values are decoded from the lexeme only here, once the token is
+// known to become a Literal node
+Value Parser::numberLiteral(const Token& token) {
+    double value = 0;
+    std::from_chars(token.lexeme.data(), token.lexeme.data() + token.lexeme.size(), value);
+    return Value::number(value);
+}
+
+Value Parser::stringLiteral(const Token& token) {
+    // Pinned: the AST and compiled code refer to it
+    Value value = Value::string(token.lexeme.substr(1, token.lexeme.size() - 2));
+    Heap::current().pin(value);
+    return value;
+}
+
 // Helpers
-bool Parser::match(std::vector<TokenType> types) {
+bool Parser::match(std::initializer_list<TokenType> types) {
     for (TokenType type : types) {
         if (check(type)) { advance(); return true; }
     }
     return false;
 }
-bool Parser::match(TokenType type) { return match(std::vector<TokenType>{type}); }
+bool Parser::match(TokenType type) {
+    if (!check(type)) return false;
+    advance();
+    return true;
+}
 bool Parser::check(TokenType type) { if (isAtEnd()) return false; return peek().type == type; }
-Token Parser::advance() { if (!isAtEnd()) current++; return previous(); }
+const Token& Parser::advance() { if (!isAtEnd()) current++; return previous(); }
 bool Parser::isAtEnd() { return peek().type == END_OF_FILE; }
-Token Parser::peek() { return tokens[current]; }
-Token Parser::previous() { return tokens[current - 1]; }
-Token Parser::consume(TokenType type, std::string message) {
+const Token& Parser::peek() {
+    while (scanned <= current) ring[scanned++ % LOOKAHEAD] = lexer.next();
+    return ring[current % LOOKAHEAD];
+}
+const Token& Parser::previous() { return ring[(current - 1) % LOOKAHEAD]; }
+const Token& Parser::consume(TokenType type, const char* message) {
     if (check(type)) return advance();
     throw std::runtime_error(message);
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "Profiler.h"
+#include <algorithm>
+
+void ShadowStack::snapshot(std::vector<int>& out) const {
+    int d = std::min(depth.load(std::memory_order_acquire), MAX_DEPTH);
+    out.resize(std::max(d, 0));
+    for (int i = 0; i < d; i++) out[i] = lines[i].load(std::memory_order_relaxed);
+}
+
+Profiler::Profiler(const ShadowStack& stack, std::string script, int hz)
+    : stack(stack), script(std::move(script)), period(std::chrono::nanoseconds(1000000000) / std::max(hz, 1)) {
+    std::replace(this->script.begin(), this->script.end(), ';', '_'); // the frame separator
+}
+
+Profiler::~Profiler() {
+    stop();
+}
+
+void Profiler::start() {
+    if (running.exchange(true)) return;
+    sampler = std::thread([this] { run(); });
+}
+
+void Profiler::stop() {
+    if (!running.exchange(false)) return;
+    sampler.join();
+}
+
+// Ticks are scheduled from the start time, not from the last wakeup, so a
+// late wakeup does not stretch the period. If the sampler falls a whole
+// tick behind it skips ahead rather than taking a burst of catch-up samples.
+void Profiler::run() {
+    std::vector<int> frames;
+    auto next = std::chrono::steady_clock::now();
+    while (running.load(std::memory_order_relaxed)) {
+        next += period;
+        std::this_thread::sleep_until(next);
+        auto now = std::chrono::steady_clock::now();
+        if (now - next > period) next = now;
+
+        stack.snapshot(frames);
+        auto it = counts.find(frames);
+        if (it == counts.end()) counts.emplace(frames, 1);
+        else it->second++;
+        total++;
+    }
+}
+
+// A stack that is empty was sampled between top-level statements and is
+// charged to the script itself
+void Profiler::writeFolded(std::ostream& out) const {
+    for (const auto& [frames, count] : counts) {
+        out << script;
+        for (int line : frames) out << ';' << script << ':' << line;
+        out << ' ' << count << '\n';
+    }
+}
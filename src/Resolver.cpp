@@ -0,0 +1,112 @@
+#include "Resolver.h"
+#include <stdexcept>
+
+void Resolver::resolve(const std::vector<Stmt*>& statements) {
+    for (Stmt* stmt : statements) resolveStmt(stmt);
+}
+
+void Resolver::resolveStmt(Stmt* stmt) {
+    switch (stmt->kind) {
+        case StmtKind::PRINT:
+            resolveExpr(static_cast<PrintStmt*>(stmt)->expression);
+            break;
+        case StmtKind::EXPRESSION:
+            resolveExpr(static_cast<ExpressionStmt*>(stmt)->expression);
+            break;
+        case StmtKind::VAR: {
+            auto* s = static_cast<VarStmt*>(stmt);
+            // The initializer sees the enclosing binding, not the one being declared
+            if (s->initializer) resolveExpr(s->initializer);
+            s->slot = declare(s->name);
+            break;
+        }
+        case StmtKind::WHILE: {
+            auto* s = static_cast<WhileStmt*>(stmt);
+            resolveExpr(s->condition);
+            resolveStmt(s->body);
+            break;
+        }
+        case StmtKind::BLOCK: {
+            auto* s = static_cast<Block*>(stmt);
+            scopes.emplace_back();
+            for (Stmt* inner : s->statements) resolveStmt(inner);
+            s->slotCount = (int)scopes.back().size();
+            scopes.pop_back();
+            break;
+        }
+        case StmtKind::FUNCTION:
+        case StmtKind::CLASS:
+            break;
+    }
+}
+
+void Resolver::resolveExpr(Expr* expr) {
+    switch (expr->kind) {
+        case ExprKind::VARIABLE: {
+            auto* e = static_cast<Variable*>(expr);
+            resolveName(e->name, e->line, e->depth, e->slot);
+            break;
+        }
+        case ExprKind::ASSIGN: {
+            auto* e = static_cast<Assign*>(expr);
+            resolveExpr(e->value);
+            resolveName(e->name, e->line, e->depth, e->slot);
+            break;
+        }
+        case ExprKind::GET:
+            resolveExpr(static_cast<Get*>(expr)->object);
+            break;
+        case ExprKind::SET: {
+            auto* e = static_cast<Set*>(expr);
+            resolveExpr(e->object);
+            resolveExpr(e->value);
+            break;
+        }
+        case ExprKind::BINARY: {
+            auto* e = static_cast<Binary*>(expr);
+            if (e->left) resolveExpr(e->left);
+            resolveExpr(e->right);
+            break;
+        }
+        case ExprKind::CALL: {
+            auto* e = static_cast<Call*>(expr);
+            resolveExpr(e->callee);
+            for (Expr* arg : e->arguments) resolveExpr(arg);
+            break;
+        }
+        case ExprKind::LITERAL:
+        case ExprKind::NEW:
+            break;
+    }
+}
+
+// Scripts have no functions and globals can only be declared at top level,
+// so a name that is not bound by the time it is referenced (in source order)
+// can never be bound when that reference executes either.
+void Resolver::resolveName(Value name, int line, int& depth, int& slot) {
+    for (int i = (int)scopes.size() - 1; i >= 0; i--) {
+        auto it = scopes[i].find(name.asHandle());
+        if (it != scopes[i].end()) {
+            depth = (int)scopes.size() - 1 - i;
+            slot = it->second;
+            return;
+        }
+    }
+    auto it = globals.find(name.asHandle());
+    if (it == globals.end()) {
+        throw std::runtime_error("[line " + std::to_string(line) + "] Undefined variable '" + std::string(name.asString()) + "'.");
+    }
+    depth = -1;
+    slot = it->second;
+}
+
+// Redeclaring a name in the same scope reuses its slot
+int Resolver::declare(Value name) {
+    auto& scope = scopes.empty() ? globals : scopes.back();
+    size_t key = name.asHandle();
+    auto it = scope.find(key);
+    if (it != scope.end()) return it->second;
+    int slot = (int)scope.size();
+    scope[key] = slot;
+    return slot;
+}
@@ -1,83 +1,657 @@
 #include "Runtime.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
+#include <stdexcept>
 
-std::unordered_map<size_t, HeapObject*> Heap::objects;
-size_t Heap::nextId = 1;
-size_t Heap::bytesAllocated = 0;
-size_t Heap::nextGC = 1024 * 1024; // 1MB threshold
+Value Value::string(std::string_view s) {
+    Value v;
+#if JLITE_NAN_BOXING
+    v.bits = SIGN_BIT | QNAN | REF_STRING | Heap::current().intern(s);
+#else
+    v.tag = STRING;
+    v.as = Heap::current().intern(s);
+#endif
+    return v;
+}
 
 std::string Value::toString() const {
-    if (type == NIL) return "null";
-    if (type == BOOL) return std::get<bool>(as) ? "true" : "false";
-    if (type == NUMBER) {
-        double d = std::get<double>(as);
+    Type t = type();
+    if (t == NIL) return "null";
+    if (t == BOOL) return asBool() ? "true" : "false";
+    if (t == NUMBER) {
+        double d = asNumber();
         // Clean trailing zeros
         std::string s = std::to_string(d);
         return s.substr(0, s.find_last_not_of('0') + 1); 
     }
-    if (type == STRING) return std::get<std::string>(as);
-    if (type == INSTANCE) return "Instance@" + std::to_string(std::get<size_t>(as));
+    if (t == STRING) return std::string(asString());
+    if (t == INSTANCE) return "Instance@" + std::to_string(Heap::slotIndex(asHandle()));
     return "";
 }
 
-size_t Heap::allocate(HeapObject* obj) {
-    // Hardcoded low limit to force GC for demonstration
-    if (objects.size() > 10) { 
-        // In real impl, we'd need access to the Interpreter's current environment here
-        // For now, we assume explicit GC calls or pass environment context during alloc.
-        std::cout << "[System] Heap pressure. (GC would trigger here)\n";
+bool Value::isTruthy() const {
+    Type t = type();
+    if (t == NIL) return false;
+    if (t == BOOL) return asBool();
+    return true;
+}
+
+// Strings are interned, so every non-number compares by identity
+bool Value::operator==(const Value& other) const {
+#if JLITE_NAN_BOXING
+    if (isNumber() && other.isNumber()) return asNumber() == other.asNumber();
+    return bits == other.bits;
+#else
+    return tag == other.tag && as == other.as;
+#endif
+}
+
+// --- Instances ---
+bool InstanceObject::getField(size_t name, Value& out) {
+    int index = shape->lookup(name);
+    if (index < 0) return false;
+    out = slot(index);
+    return true;
+}
+
+void InstanceObject::setField(size_t name, const Value& value) {
+    Heap::current().writeBarrier(this, value);
+    int index = shape->lookup(name);
+    if (index >= 0) {
+        slot(index) = value;
+        return;
+    }
+    appendSlot(shape->addField(name), value);
+}
+
+// --- Strings ---
+// FNV-1a
+uint32_t StringObject::hashString(std::string_view s) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : s) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+size_t StringTable::find(std::string_view chars, uint32_t hash) const {
+    if (entries.empty()) return 0;
+    size_t mask = entries.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Entry& e = entries[i];
+        if (e.key == nullptr) {
+            if (e.addr == 0) return 0; // empty slot ends the probe; tombstones don't
+        } else if (e.key->hash == hash && e.key->chars() == chars) {
+            return e.addr;
+        }
+    }
+}
+
+void StringTable::insert(StringObject* str, size_t addr) {
+    if ((used + 1) * 4 > entries.size() * 3) grow();
+    size_t mask = entries.size() - 1;
+    size_t i = str->hash & mask;
+    while (entries[i].key != nullptr) i = (i + 1) & mask;
+    if (entries[i].addr == 0) used++; // reusing a tombstone doesn't add to the load
+    entries[i] = {str, addr};
+    count++;
+}
+
+void StringTable::remove(StringObject* str) {
+    size_t mask = entries.size() - 1;
+    for (size_t i = str->hash & mask;; i = (i + 1) & mask) {
+        if (entries[i].key == str) {
+            entries[i].key = nullptr; // leave addr set as a tombstone
+            count--;
+            return;
+        }
+        if (entries[i].key == nullptr && entries[i].addr == 0) return;
+    }
+}
+
+// Rehashes into a table twice as large, dropping tombstones
+void StringTable::grow() {
+    std::vector<Entry> old = std::move(entries);
+    entries.assign(old.empty() ? 64 : old.size() * 2, Entry{});
+    count = used = 0;
+    for (const Entry& e : old) {
+        if (e.key) insert(e.key, e.addr);
+    }
+}
+
+size_t Heap::intern(std::string_view chars) {
+    uint32_t hash = StringObject::hashString(chars);
+    if (size_t addr = strings.find(chars, hash)) {
+        // A dead string the sweep hasn't reached yet is live again
+        uint32_t index = slotIndex(addr);
+        if (phase == SWEEPING && index >= sweepCursor) slots[index].object->marked = true;
+        return addr;
     }
-    
-    size_t id = nextId++;
-    objects[id] = obj;
-    return id;
+    size_t size = sizeof(StringObject) + chars.size() + 1;
+    maybeCollect(size);
+    uint8_t sizeClass;
+    void* mem = allocator.allocate(size, sizeClass);
+    auto* str = new (mem) StringObject(hash, (uint32_t)chars.size());
+    str->sizeClass = sizeClass;
+    char* data = reinterpret_cast<char*>(str + 1);
+    std::memcpy(data, chars.data(), chars.size());
+    data[chars.size()] = '\0';
+    bytesAllocated += PoolAllocator::blockSize(mem, sizeClass);
+    size_t addr = track(str);
+    strings.insert(str, addr);
+    return addr;
+}
+
+// Pinned objects are never swept, so they go straight to the old generation
+void Heap::pin(const Value& val) {
+    HeapObject* obj = get(val.asHandle());
+    obj->pinned = true;
+    obj->old = true;
 }
 
-HeapObject* Heap::get(size_t addr) {
-    if (objects.find(addr) != objects.end()) return objects.at(addr);
+Shape* Heap::rootShape(size_t className) {
+    Shape*& shape = shapes[className];
+    if (!shape) shape = new Shape(nullptr, className);
+    return shape;
+}
+
+// Runs when an isolate is done: nothing can reference its objects any more
+Heap::~Heap() {
+    for (const Slot& slot : slots) {
+        if (slot.object) release(slot.object);
+    }
+    for (auto& root : shapes) delete root.second;
+}
+
+size_t Heap::track(HeapObject* obj) {
+    uint32_t index = freeList;
+    if (index != 0) {
+        freeList = slots[index].nextFree;
+        slots[index].object = obj;
+    } else {
+        if (slots.size() > UINT32_MAX) throw std::runtime_error("Out of heap handles.");
+        index = (uint32_t)slots.size();
+        slots.push_back({obj, 0, 0});
+    }
+    objectCount++;
+    JLITE_COUNT(allocations++);
+    // Allocated black during a cycle, unless the sweep has already passed its slot
+    obj->marked = phase == MARKING || (phase == SWEEPING && index >= sweepCursor);
+    size_t addr = (size_t(slots[index].generation) << 32) | index;
+    nursery.push_back(addr);
+    youngBytes += sizeOf(obj);
+    return addr;
+}
+
+void Heap::freeSlot(uint32_t index) {
+    Slot& slot = slots[index];
+    HeapObject* obj = slot.object;
+    // The intern table is weak: drop dead strings from it
+    if (obj->kind == HeapObject::STRING) strings.remove(static_cast<StringObject*>(obj));
+    bytesAllocated -= sizeOf(obj);
+    release(obj);
+    slot.object = nullptr;
+    slot.generation++;
+    slot.nextFree = freeList;
+    freeList = index;
+    objectCount--;
+    JLITE_COUNT(objectsFreed++);
+}
+
+size_t Heap::sizeOf(const HeapObject* obj) {
+    size_t bytes = PoolAllocator::blockSize(obj, obj->sizeClass);
+    if (obj->kind == HeapObject::INSTANCE) {
+        bytes += static_cast<const InstanceObject*>(obj)->extraSlots.capacity() * sizeof(Value);
+    }
+    return bytes;
+}
+
+void Heap::release(HeapObject* obj) {
+    uint8_t sizeClass = obj->sizeClass;
+    obj->~HeapObject();
+    allocator.free(obj, sizeClass);
+}
+
+void Heap::freedAccess() {
     throw std::runtime_error("Segmentation Fault: Accessing freed memory.");
 }
 
-void Heap::mark(Value val) {
-    if (val.type == Value::INSTANCE) {
-        size_t addr = std::get<size_t>(val.as);
-        if (objects.find(addr) != objects.end()) {
-            markObject(objects[addr]);
+void Heap::mark(const Value& val) {
+    if (val.isObject()) {
+        size_t addr = val.asHandle();
+        uint32_t index = slotIndex(addr);
+        if (index < slots.size() && slots[index].generation == uint16_t(addr >> 32)) {
+            markObject(slots[index].object);
         }
     }
 }
 
+// White objects turn gray here: marked, and queued on the gray worklist
+// if they have fields to trace. Strings have none, so they go straight to black.
 void Heap::markObject(HeapObject* obj) {
-    if (obj == nullptr || obj->marked) return;
+    // A minor collection treats old objects as live without tracing them
+    if (obj == nullptr || obj->marked || (minorGC && obj->old)) return;
     obj->marked = true;
+    if (obj->kind == HeapObject::INSTANCE) grayStack.push_back(obj);
+}
 
-    // If it's an instance, traverse its fields
-    if (auto* inst = dynamic_cast<InstanceObject*>(obj)) {
-        for (auto& pair : inst->fields) {
-            mark(pair.second);
+// Blackens one gray object. Field names are identifiers from the source,
+// which are pinned, so only the values need marking.
+void Heap::blacken(HeapObject* obj) {
+    auto* inst = static_cast<InstanceObject*>(obj);
+    for (size_t i = 0; i < inst->shape->slotCount(); i++) {
+        mark(inst->slot(i));
+    }
+}
+
+void Heap::traceReferences() {
+    if (!minorGC && workers.size() > 1) {
+        traceParallel();
+        return;
+    }
+    while (!grayStack.empty()) {
+        HeapObject* obj = grayStack.back();
+        grayStack.pop_back();
+        blacken(obj);
+    }
+}
+
+// --- Parallel marking ---
+//
+// Each marker drains a private stack. When it grows past PUBLISH_AT, half of
+// it moves to the marker's shared deque, where idle markers can steal it.
+// Marking is claimed with an atomic exchange on the mark bit, so an object
+// is traced by exactly one marker. Nothing allocates or mutates while this
+// runs; the slot table, shapes and fields are only read.
+namespace {
+
+struct MarkDeque {
+    std::mutex lock;
+    std::deque<HeapObject*> items;
+};
+
+inline bool claim(HeapObject* obj) {
+    return !__atomic_exchange_n(&obj->marked, true, __ATOMIC_RELAXED);
+}
+
+} // namespace
+
+void Heap::traceParallel() {
+    const size_t PUBLISH_AT = 256;
+    size_t markers = workers.size();
+    std::vector<MarkDeque> deques(markers);
+    for (size_t i = 0; i < grayStack.size(); i++) deques[i % markers].items.push_back(grayStack[i]);
+    grayStack.clear();
+    std::atomic<size_t> idle{0};
+
+    auto take = [&](MarkDeque& from, std::vector<HeapObject*>& into, bool half) {
+        std::lock_guard<std::mutex> guard(from.lock);
+        size_t n = half ? (from.items.size() + 1) / 2 : from.items.size();
+        for (size_t i = 0; i < n; i++) {
+            into.push_back(from.items.front());
+            from.items.pop_front();
+        }
+        return n > 0;
+    };
+    auto anyWork = [&] {
+        for (auto& d : deques) {
+            std::lock_guard<std::mutex> guard(d.lock);
+            if (!d.items.empty()) return true;
         }
+        return false;
+    };
+
+    workers.run([&](size_t self) {
+        std::vector<HeapObject*> local;
+        for (;;) {
+            while (!local.empty()) {
+                auto* inst = static_cast<InstanceObject*>(local.back());
+                local.pop_back();
+                for (size_t i = 0; i < inst->shape->slotCount(); i++) {
+                    const Value& v = inst->slot(i);
+                    if (!v.isObject()) continue;
+                    size_t addr = v.asHandle();
+                    const Slot& slot = slots[slotIndex(addr)];
+                    if (slot.generation != uint16_t(addr >> 32)) continue;
+                    HeapObject* target = slot.object;
+                    if (claim(target) && target->kind == HeapObject::INSTANCE) local.push_back(target);
+                }
+                if (local.size() >= PUBLISH_AT) {
+                    std::lock_guard<std::mutex> guard(deques[self].lock);
+                    size_t half = local.size() / 2;
+                    deques[self].items.insert(deques[self].items.end(), local.begin(), local.begin() + half);
+                    local.erase(local.begin(), local.begin() + half);
+                }
+            }
+            if (take(deques[self], local, false)) continue;
+            bool stolen = false;
+            for (size_t k = 1; k < markers && !stolen; k++) stolen = take(deques[(self + k) % markers], local, true);
+            if (stolen) continue;
+
+            // Out of work: done once every marker is idle with nothing left to steal
+            idle++;
+            for (;;) {
+                if (idle.load() == markers) return;
+                if (anyWork()) {
+                    idle--;
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+    });
+}
+
+// Sweeps slots [from, to). With GC workers, the table is scanned in parallel
+// chunks that reset survivors and collect dead slots; freeing touches the
+// allocator, the slot free list and the intern table, so it stays serial.
+void Heap::sweepRange(uint32_t from, uint32_t to) {
+    size_t markers = workers.size();
+    if (markers == 1 || to - from < PARALLEL_SWEEP_MIN) {
+        for (uint32_t i = from; i < to; i++) sweepSlot(i);
+        return;
     }
+    std::vector<std::vector<uint32_t>> dead(markers);
+    uint32_t chunk = (to - from + markers - 1) / markers;
+    workers.run([&](size_t self) {
+        uint32_t begin = from + uint32_t(self) * chunk;
+        uint32_t end = std::min(to, begin + chunk);
+        for (uint32_t i = begin; i < end; i++) {
+            HeapObject* obj = slots[i].object;
+            if (obj == nullptr) continue;
+            if (!obj->marked && !obj->pinned) {
+                dead[self].push_back(i);
+            } else {
+                obj->marked = false;
+                obj->old = true;
+            }
+        }
+    });
+    for (auto& list : dead) {
+        for (uint32_t i : list) freeSlot(i);
+    }
+}
+
+// Frees slot i if it is unmarked, otherwise resets it for the next cycle.
+// Every survivor of a full collection is promoted.
+void Heap::sweepSlot(uint32_t i) {
+    HeapObject* obj = slots[i].object;
+    if (obj == nullptr) return;
+    if (!obj->marked && !obj->pinned) {
+        freeSlot(i);
+    } else {
+        obj->marked = false;
+        obj->old = true;
+    }
+}
+
+// Objects allocated while a full sweep was in progress may still be in the
+// nursery; they are promoted too, so no old-to-young references remain.
+void Heap::finishSweep() {
+    for (size_t addr : nursery) {
+        uint32_t index = slotIndex(addr);
+        if (slots[index].generation == uint16_t(addr >> 32)) slots[index].object->old = true;
+    }
+    nursery.clear();
+    youngBytes = 0;
+    allocator.releaseEmptyPages();
 }
 
+// Linear scan of the slot table. Freed slots get a new generation so any
+// handle still pointing at them fails the check in Heap::get.
 void Heap::sweep() {
-    auto it = objects.begin();
-    while (it != objects.end()) {
-        if (!it->second->marked) {
-            delete it->second;
-            it = objects.erase(it);
+    forgetRemembered();
+    sweepRange(1, (uint32_t)slots.size());
+    finishSweep();
+}
+
+// Only the nursery is swept. Survivors age, and those old enough are
+// promoted; the remembered set is then rebuilt from the old objects
+// (previously remembered or just promoted) that still reference young ones.
+void Heap::sweepYoung() {
+    std::vector<HeapObject*> candidates = std::move(rememberedSet);
+    rememberedSet.clear();
+    size_t kept = 0;
+    youngBytes = 0;
+    for (size_t addr : nursery) {
+        uint32_t index = slotIndex(addr);
+        HeapObject* obj = slots[index].object;
+        if (obj->old) continue; // pinned since it was allocated
+        if (!obj->marked) {
+            freeSlot(index);
+            continue;
+        }
+        obj->marked = false;
+        if (++obj->age >= promotionAge) {
+            obj->old = true;
+            if (obj->kind == HeapObject::INSTANCE) candidates.push_back(obj);
         } else {
-            it->second->marked = false; // Reset for next cycle
-            ++it;
+            nursery[kept++] = addr;
+            youngBytes += sizeOf(obj);
+        }
+    }
+    nursery.resize(kept);
+
+    for (HeapObject* obj : candidates) {
+        obj->remembered = pointsIntoNursery(obj);
+        if (obj->remembered) rememberedSet.push_back(obj);
+    }
+    allocator.releaseEmptyPages();
+}
+
+// Minor collections are suspended during a full cycle, and the cycle ends
+// with everything promoted, so the remembered set is dropped when one starts.
+void Heap::forgetRemembered() {
+    for (HeapObject* obj : rememberedSet) obj->remembered = false;
+    rememberedSet.clear();
+}
+
+void Heap::barrierSlow(HeapObject* obj, const Value& value) {
+    HeapObject* target = get(value.asHandle());
+    if (phase == MARKING) {
+        // Storing a white object into a marked one must not hide it from the marker
+        if (obj->marked) markObject(target);
+        return;
+    }
+    if (phase == IDLE && obj->old && !obj->remembered && !target->old) {
+        obj->remembered = true;
+        rememberedSet.push_back(obj);
+    }
+}
+
+bool Heap::pointsIntoNursery(HeapObject* obj) {
+    auto* inst = static_cast<InstanceObject*>(obj);
+    for (size_t i = 0; i < inst->shape->slotCount(); i++) {
+        const Value& v = inst->slot(i);
+        if (v.isObject() && !slots[slotIndex(v.asHandle())].object->old) return true;
+    }
+    return false;
+}
+
+void Heap::dumpStats(std::ostream& out) {
+    char pause[32];
+    std::snprintf(pause, sizeof pause, "%.3f ms", lastPauseMs);
+    if (minorGC) {
+        out << "[heap] minor GC " << minorCollections << " (" << pause << "): " << objectCount << " objects, "
+            << youngBytes << " young bytes, " << rememberedSet.size() << " remembered\n";
+        return;
+    }
+    out << "[heap] after GC " << collections << " (last pause " << pause << "): " << objectCount << " objects, "
+        << bytesAllocated << " bytes live, next GC at " << nextGC << " bytes\n";
+    allocator.dumpStats(out);
+}
+
+void Heap::addRoots(GCRoots* source) {
+    roots.push_back(source);
+}
+
+void Heap::removeRoots(GCRoots* source) {
+    roots.erase(std::remove(roots.begin(), roots.end(), source), roots.end());
+}
+
+// --- Full collections ---
+//
+// With a pause budget, a full collection is a cycle of bounded slices run
+// from allocation: roots are shaded gray, each slice blackens gray objects
+// until the budget is spent, and once the worklist is empty the roots are
+// scanned again (they have no barrier) and the remainder is drained in one
+// short pause. The slot table is then swept a slice at a time. Objects
+// allocated while marking, or ahead of the sweep cursor, start out marked
+// so the cycle keeps them. Field stores during marking go through
+// Heap::writeBarrier, which shades the stored object if the holder is
+// already marked.
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Heap::recordPause(const char* what, double ms) {
+    lastPauseMs = ms;
+    pauseCount++;
+    JLITE_COUNT(totalPauseMs += ms, maxPauseMs = std::max(maxPauseMs, ms));
+    if (traceGC) {
+        char line[96];
+        std::snprintf(line, sizeof line, "[gc] %-8s %9.1f us\n", what, ms * 1000.0);
+        std::cerr << line;
+        pauseLog.push_back(ms);
+    }
+}
+
+void Heap::startCycle() {
+    forgetRemembered();
+    phase = MARKING;
+    for (GCRoots* source : roots) source->markRoots();
+}
+
+void Heap::finishCycle() {
+    phase = IDLE;
+    finishSweep();
+    collections++;
+    nextGC = std::max(size_t(double(bytesAllocated) * growthFactor), minHeap);
+    if (traceStats) dumpStats(std::cerr);
+}
+
+// Ends marking: rescans the roots and drains whatever they reach
+void Heap::remark() {
+    for (GCRoots* source : roots) source->markRoots();
+    traceReferences();
+    phase = SWEEPING;
+    sweepCursor = 1;
+}
+
+// One slice of the current cycle. The clock is only read every few dozen
+// objects, so a slice can overshoot the budget by that much work.
+void Heap::step() {
+    const size_t CHECK_EVERY = 64;
+    auto start = std::chrono::steady_clock::now();
+    double budgetMs = pauseBudgetUs / 1000.0;
+    const char* what = phase == MARKING ? "mark" : "sweep";
+
+    // The heap outgrew the cycle (allocation outpacing marking): finish now
+    if (bytesAllocated > 2 * nextGC) {
+        collectGarbage();
+        return;
+    }
+
+    if (phase == MARKING) {
+        size_t work = 0;
+        while (!grayStack.empty()) {
+            HeapObject* obj = grayStack.back();
+            grayStack.pop_back();
+            blacken(obj);
+            if (++work % CHECK_EVERY == 0 && msSince(start) >= budgetMs) break;
+        }
+        if (grayStack.empty()) {
+            remark();
+            what = "remark";
+        }
+    }
+    if (phase == SWEEPING && pauseBudgetUs == 0) {
+        // Lazy sweep after a stop-the-world mark: a fixed chunk per worker
+        // and slice, so several workers share a slice and sweep it in parallel
+        size_t slice = LAZY_SWEEP_SLOTS * workers.size();
+        uint32_t end = (uint32_t)std::min<size_t>(slots.size(), size_t(sweepCursor) + slice);
+        sweepRange(sweepCursor, end);
+        sweepCursor = end;
+        if (sweepCursor >= slots.size()) {
+            recordPause(what, msSince(start));
+            finishCycle();
+            return;
+        }
+    } else if (phase == SWEEPING && msSince(start) < budgetMs) {
+        size_t end = slots.size();
+        while (sweepCursor < end) {
+            sweepSlot(sweepCursor++);
+            if (sweepCursor % CHECK_EVERY == 0 && msSince(start) >= budgetMs) break;
+        }
+        if (sweepCursor >= slots.size()) {
+            recordPause(what, msSince(start));
+            finishCycle();
+            return;
         }
     }
+    nextSlice = bytesAllocated + SLICE_BYTES;
+    recordPause(what, msSince(start));
 }
 
-void Heap::collectGarbage(Environment* env) {
-    std::cout << "-- GC BEGIN --\n";
-    // 1. Mark Roots (We need to implement Environment traversal)
-    // See Interpreter.cpp for the actual implementation linking Env -> Mark
-    
-    // 2. Sweep
-    sweep();
-    std::cout << "-- GC END. Objects remaining: " << objects.size() << " --\n";
-}
\ No newline at end of file
+// Without a pause budget the whole mark runs in this pause (on the GC
+// workers, if any) and the sweep is left to later allocations.
+void Heap::startCollection() {
+    if (pauseBudgetUs == 0) {
+        auto start = std::chrono::steady_clock::now();
+        startCycle();
+        traceReferences();
+        remark();
+        nextSlice = bytesAllocated + SLICE_BYTES;
+        recordPause("mark", msSince(start));
+        return;
+    }
+    startCycle();
+    step();
+}
+
+// Stop-the-world full collection, or the rest of an incremental cycle
+void Heap::collectGarbage() {
+    auto start = std::chrono::steady_clock::now();
+    if (phase == IDLE) startCycle();
+    if (phase == MARKING) {
+        traceReferences();
+        remark();
+    }
+    sweepRange(sweepCursor, (uint32_t)slots.size());
+    sweepCursor = (uint32_t)slots.size();
+    recordPause("full", msSince(start));
+    finishCycle();
+}
+
+// Minor collection: roots and remembered old objects are traced, marking
+// stops at old objects, and only the nursery is swept.
+void Heap::collectYoung() {
+    auto start = std::chrono::steady_clock::now();
+    minorGC = true;
+    for (GCRoots* source : roots) source->markRoots();
+    for (HeapObject* obj : rememberedSet) grayStack.push_back(obj);
+    traceReferences();
+    sweepYoung();
+    minorCollections++;
+    recordPause("minor", msSince(start));
+    if (traceStats) dumpStats(std::cerr);
+    minorGC = false;
+}
+
+// Pause distribution over the whole run, for --gc-trace
+void Heap::dumpPauses(std::ostream& out) {
+    if (pauseLog.empty()) return;
+    std::vector<double> ms = pauseLog;
+    std::sort(ms.begin(), ms.end());
+    auto at = [&](double q) { return ms[std::min(ms.size() - 1, size_t(q * ms.size()))] * 1000.0; };
+    char line[160];
+    std::snprintf(line, sizeof line, "[gc] %zu pauses: p50 %.1f us, p99 %.1f us, max %.1f us (budget %zu us)\n",
+                  ms.size(), at(0.50), at(0.99), ms.back() * 1000.0, pauseBudgetUs);
+    out << line;
+}
@@ -0,0 +1,53 @@
+#include "ScanKernels.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const scan::Kernels SCALAR = {"scalar", scalarWhitespace, scalarLineEnd, scalarStringEnd, scalarIdentifier, scalarDigits};
+
+#if defined(__SSE2__)
+struct Sse2 {
+    using Vec = __m128i;
+    static constexpr int WIDTH = 16;
+    static constexpr uint32_t ALL = 0xFFFF;
+    static Vec load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static Vec splat(char c) { return _mm_set1_epi8(c); }
+    static Vec equal(Vec a, Vec b) { return _mm_cmpeq_epi8(a, b); }
+    static Vec greater(Vec a, Vec b) { return _mm_cmpgt_epi8(a, b); }
+    static Vec bitAnd(Vec a, Vec b) { return _mm_and_si128(a, b); }
+    static Vec bitOr(Vec a, Vec b) { return _mm_or_si128(a, b); }
+    static uint32_t mask(Vec v) { return uint32_t(_mm_movemask_epi8(v)); }
+};
+
+const scan::Kernels SSE2 = SimdKernels<Sse2>::table("sse2");
+#endif
+
+bool hasAvx2() {
+#if defined(__x86_64__) || defined(__i386__)
+    return scan::avx2Kernels() && __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+namespace scan {
+
+std::vector<const Kernels*> available() {
+    std::vector<const Kernels*> kernels = {&SCALAR};
+#if defined(__SSE2__)
+    kernels.push_back(&SSE2);
+#endif
+    if (hasAvx2()) kernels.push_back(avx2Kernels());
+    return kernels;
+}
+
+const Kernels& best() {
+    static const Kernels* chosen = available().back();
+    return *chosen;
+}
+
+} // namespace scan
@@ -0,0 +1,29 @@
+// Built with -mavx2 on x86 (see CMakeLists.txt). Nothing here runs unless
+// scan::best() has checked that the CPU supports AVX2.
+#include "ScanKernels.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+
+struct Avx2 {
+    using Vec = __m256i;
+    static constexpr int WIDTH = 32;
+    static constexpr uint32_t ALL = 0xFFFFFFFF;
+    static Vec load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static Vec splat(char c) { return _mm256_set1_epi8(c); }
+    static Vec equal(Vec a, Vec b) { return _mm256_cmpeq_epi8(a, b); }
+    static Vec greater(Vec a, Vec b) { return _mm256_cmpgt_epi8(a, b); }
+    static Vec bitAnd(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+    static Vec bitOr(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+    static uint32_t mask(Vec v) { return uint32_t(_mm256_movemask_epi8(v)); }
+};
+
+const scan::Kernels AVX2 = SimdKernels<Avx2>::table("avx2");
+
+} // namespace
+
+const scan::Kernels* scan::avx2Kernels() { return &AVX2; }
+#else
+const scan::Kernels* scan::avx2Kernels() { return nullptr; }
+#endif
@@ -0,0 +1,38 @@
+#include "Shape.h"
+#include "Runtime.h"
+
+std::atomic<size_t> Shape::shapeCount{0};
+
+Shape* Shape::root(size_t className) {
+    return Heap::current().rootShape(className);
+}
+
+Shape::~Shape() {
+    shapeCount--;
+    for (auto& transition : transitions) delete transition.second;
+}
+
+int Shape::lookup(size_t name) const {
+    if (names.size() <= LINEAR_LOOKUP_MAX) {
+        for (size_t i = 0; i < names.size(); i++) {
+            if (names[i] == name) return (int)i;
+        }
+        return -1;
+    }
+    auto it = index.find(name);
+    return it != index.end() ? it->second : -1;
+}
+
+Shape* Shape::addField(size_t name) {
+    auto it = transitions.find(name);
+    if (it != transitions.end()) return it->second;
+
+    Shape* next = new Shape(this, className);
+    next->names = names;
+    next->names.push_back(name);
+    if (next->names.size() > LINEAR_LOOKUP_MAX) {
+        for (size_t i = 0; i < next->names.size(); i++) next->index[next->names[i]] = (int)i;
+    }
+    transitions[name] = next;
+    return next;
+}
@@ -0,0 +1,39 @@
+#include "Source.h"
+#include <fcntl.h>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SourceBuffer::SourceBuffer(const std::string& path) {
+    if (path == "-") {
+        owned.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        return;
+    }
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Could not open file " + path);
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* p = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            mapped = static_cast<const char*>(p);
+            mappedSize = size_t(info.st_size);
+            close(fd);
+            return;
+        }
+    }
+
+    // Empty files, pipes and anything else mmap refuses
+    char buffer[64 * 1024];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) owned.append(buffer, size_t(n));
+    close(fd);
+    if (n < 0) throw std::runtime_error("Could not read file " + path);
+}
+
+SourceBuffer::~SourceBuffer() {
+    if (mapped) munmap(const_cast<char*>(mapped), mappedSize);
+}
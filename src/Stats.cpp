@@ -0,0 +1,114 @@
+#include "Stats.h"
+#include "Chunk.h"
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if JLITE_STATS
+static const char* PHASES[] = {"cache", "parse", "resolve", "optimize", "compile", "execute"};
+static const char* EXPR_NAMES[] = {"binary", "literal", "variable", "assign", "new", "get", "set", "call"};
+static const char* STMT_NAMES[] = {"expression", "print", "var", "while", "block", "function", "class"};
+#endif
+
+namespace {
+
+// Collects "name value" pairs and prints them either way
+struct Section {
+    std::string title;
+    std::vector<std::pair<std::string, std::string>> fields;
+
+    void add(const std::string& name, uint64_t value) { fields.emplace_back(name, std::to_string(value)); }
+    void add(const std::string& name, double value) {
+        char text[32];
+        std::snprintf(text, sizeof text, "%.3f", value);
+        fields.emplace_back(name, text);
+    }
+};
+
+// Nonzero counts, largest first
+template <size_t N>
+Section counts(const char* title, const uint64_t (&values)[N], const char* (*name)(size_t)) {
+    std::vector<size_t> order;
+    for (size_t i = 0; i < N; i++) {
+        if (values[i]) order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return values[a] > values[b]; });
+    Section section{title, {}};
+    for (size_t i : order) section.add(name(i), values[i]);
+    return section;
+}
+
+} // namespace
+
+void Stats::dump(std::ostream& out, const Heap& heap, bool json) const {
+    std::vector<Section> sections;
+#if JLITE_STATS
+    Section phases{"phases_ms", {}};
+    for (size_t i = 0; i < PHASE_COUNT; i++) phases.add(PHASES[i], phaseMs[i]);
+    sections.push_back(phases);
+
+    Section gc{"gc", {}};
+    gc.add("full", uint64_t(heap.collections));
+    gc.add("minor", uint64_t(heap.minorCollections));
+    gc.add("pauses", uint64_t(heap.pauseCount));
+    gc.add("pause_total_ms", heap.totalPauseMs);
+    gc.add("pause_max_ms", heap.maxPauseMs);
+    sections.push_back(gc);
+
+    Section memory{"heap", {}};
+    memory.add("allocations", uint64_t(heap.allocations));
+    memory.add("freed", uint64_t(heap.objectsFreed));
+    memory.add("live", uint64_t(heap.objectCount));
+    memory.add("live_bytes", uint64_t(heap.bytesAllocated));
+    sections.push_back(memory);
+
+    Section env{"environment", {}};
+    env.add("lookups", envLookups);
+    env.add("hops", envHops);
+    env.add("hops_per_lookup", envLookups ? double(envHops) / envLookups : 0.0);
+    sections.push_back(env);
+
+    sections.push_back(counts("expressions", exprs, [](size_t i) { return EXPR_NAMES[i]; }));
+    sections.push_back(counts("statements", stmts, [](size_t i) { return STMT_NAMES[i]; }));
+    sections.push_back(counts("instructions", instructions, [](size_t i) { return opName(uint8_t(i)); }));
+#else
+    (void)heap;
+#endif
+
+    if (json) {
+        out << "{";
+        for (size_t s = 0; s < sections.size(); s++) {
+            out << (s ? ", " : "") << "\"" << sections[s].title << "\": {";
+            for (size_t f = 0; f < sections[s].fields.size(); f++) {
+                const auto& [name, value] = sections[s].fields[f];
+                out << (f ? ", " : "") << "\"" << name << "\": " << value;
+            }
+            out << "}";
+        }
+        out << "}\n";
+        return;
+    }
+    out << "Stats:\n";
+    if (sections.empty()) out << "  (built with JLITE_STATS=OFF)\n";
+    for (const Section& section : sections) {
+        if (section.fields.empty()) continue;
+        const size_t INDENT = 17, WIDTH = 120;
+        std::string line = "  " + section.title + ":";
+        line.resize(std::max(line.size() + 1, INDENT), ' ');
+        bool first = true;
+        for (const auto& [name, value] : section.fields) {
+            std::string item = name + " " + value;
+            if (!first && line.size() + item.size() + 2 > WIDTH) {
+                out << line << "\n";
+                line = std::string(INDENT, ' ');
+                first = true;
+            }
+            line += (first ? "" : "  ") + item;
+            first = false;
+        }
+        out << line << "\n";
+    }
+}
@@ -0,0 +1,47 @@
+#include "TypeFeedback.h"
+#include "Isolate.h"
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+// Sites are registered when they first execute, so only executed sites are listed
+static std::vector<BinaryFeedback*>& sites() {
+    return Isolate::current().feedbackSites;
+}
+
+BinaryFeedback::State BinaryFeedback::enter(State next) {
+    sites().push_back(this);
+    return state = next;
+}
+
+static const char* symbol(TokenType op) {
+    switch (op) {
+        case PLUS: return "+";
+        case MINUS: return "-";
+        case STAR: return "*";
+        case SLASH: return "/";
+        case GREATER: return ">";
+        case GREATER_EQUAL: return ">=";
+        case LESS: return "<";
+        case LESS_EQUAL: return "<=";
+        default: return "?";
+    }
+}
+
+void BinaryFeedback::dumpStats(std::ostream& out) {
+    static const char* states[] = {"uninitialized", "number", "string", "generic"};
+    std::vector<BinaryFeedback*> sorted = sites();
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](BinaryFeedback* a, BinaryFeedback* b) { return a->line < b->line; });
+
+    char row[128];
+    out << "Type feedback stats:\n";
+    std::snprintf(row, sizeof row, "%6s  %-2s  %-13s  %12s  %6s\n", "line", "op", "state", "specialized", "deopts");
+    out << row;
+    for (BinaryFeedback* site : sorted) {
+        std::snprintf(row, sizeof row, "%6d  %-2s  %-13s  %12llu  %6llu\n", site->line, symbol(site->op),
+                      states[site->state], (unsigned long long)site->hits, (unsigned long long)site->deopts);
+        out << row;
+    }
+}
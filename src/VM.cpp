@@ -0,0 +1,235 @@
+#include "VM.h"
+#include "Isolate.h"
+#include <iostream>
+
+VM::VM(std::ostream& out, std::ostream& err) : heap(Heap::current()), stats(Isolate::current().stats), out(out), err(err) {
+    stack.reserve(256);
+    heap.addRoots(this);
+}
+
+VM::~VM() {
+    heap.removeRoots(this);
+}
+
+bool VM::interpret(Chunk& c) {
+    chunk = &c;
+    ip = c.code.data();
+    bool ok = true;
+    try {
+        run();
+    } catch (std::runtime_error& e) {
+        err << "Runtime Error: " << e.what() << "\n";
+        ok = false;
+    }
+    stack.clear();
+    return ok;
+}
+
+size_t VM::readIndex() {
+    size_t index = (size_t(ip[0]) << 16) | (size_t(ip[1]) << 8) | ip[2];
+    ip += 3;
+    return index;
+}
+
+size_t VM::readSlot() {
+    size_t slot = (size_t(ip[0]) << 8) | ip[1];
+    ip += 2;
+    return slot;
+}
+
+const Value& VM::readConstant() {
+    return chunk->constants[readIndex()];
+}
+
+int VM::currentLine() const {
+    size_t offset = ip - chunk->code.data();
+    return offset ? chunk->lines[offset - 1] : 0;
+}
+
+// Roots are the value stack, the globals and the constant pool (which holds
+// heap strings under the NaN-boxed layout).
+void VM::markRoots() {
+    for (const Value& v : stack) heap.mark(v);
+    for (const Value& v : globals) heap.mark(v);
+    if (chunk) {
+        for (const Value& v : chunk->constants) heap.mark(v);
+    }
+}
+
+static uint8_t numberForm(uint8_t op) {
+    switch (op) {
+        case OP_ADD: return OP_ADD_NUM;
+        case OP_SUBTRACT: return OP_SUBTRACT_NUM;
+        case OP_MULTIPLY: return OP_MULTIPLY_NUM;
+        case OP_DIVIDE: return OP_DIVIDE_NUM;
+        case OP_GREATER: return OP_GREATER_NUM;
+        case OP_GREATER_EQUAL: return OP_GREATER_EQUAL_NUM;
+        case OP_LESS: return OP_LESS_NUM;
+        default: return OP_LESS_EQUAL_NUM;
+    }
+}
+
+// Generic arithmetic and relational ops: the first execution specializes the
+// site for its operand types and rewrites the instruction in place
+void VM::observe() {
+    uint8_t& op = chunk->code[ip - 1 - chunk->code.data()];
+    BinaryFeedback& site = chunk->feedback[readIndex()];
+    if (site.state != BinaryFeedback::UNINITIALIZED) return;
+    switch (site.specialize(peek(1), peek(0))) {
+        case BinaryFeedback::NUMBER: op = numberForm(op); break;
+        case BinaryFeedback::STRING: op = OP_ADD_STR; break;
+        default: break;
+    }
+}
+
+// A quickened op whose guard failed: rewrite it back to its generic form for
+// good and execute that instead
+void VM::deoptimize(uint8_t generic) {
+    size_t offset = ip - 1 - chunk->code.data();
+    chunk->feedback[readIndex()].deoptimize();
+    chunk->code[offset] = generic;
+    ip = chunk->code.data() + offset;
+}
+
+void VM::run() {
+#define NUMERIC_OPERANDS()                                                  \
+    observe();                                                              \
+    if (!peek(0).isNumber() || !peek(1).isNumber())                         \
+        throw std::runtime_error("Operands must be numbers.");              \
+    double b = pop().asNumber();                                            \
+    double a = pop().asNumber()
+
+// Operands of a number-specialized op; deoptimizes if either is not a number
+#define QUICK_NUMERIC(generic)                                              \
+    if (!peek(0).isNumber() || !peek(1).isNumber()) {                       \
+        deoptimize(generic);                                                \
+        break;                                                              \
+    }                                                                       \
+    chunk->feedback[readIndex()].hits++;                                    \
+    double b = pop().asNumber();                                            \
+    Value& a = peek()
+
+#if JLITE_STATS
+    uint64_t* executed = stats.instructions;
+#endif
+    for (;;) {
+        uint8_t instruction = *ip++;
+        JLITE_COUNT(executed[instruction]++);
+        switch (instruction) {
+            case OP_CONSTANT: push(chunk->constants[readIndex()]); break;
+            case OP_NIL:   push(Value::nil()); break;
+            case OP_TRUE:  push(Value::boolean(true)); break;
+            case OP_FALSE: push(Value::boolean(false)); break;
+            case OP_POP:   stack.pop_back(); break;
+            case OP_POPN:  stack.resize(stack.size() - readSlot()); break;
+
+            case OP_DEFINE_GLOBAL: {
+                size_t index = readIndex();
+                if (index >= globals.size()) globals.resize(index + 1);
+                globals[index] = pop();
+                break;
+            }
+            // The Resolver guarantees a global is defined before it is used
+            case OP_GET_GLOBAL: push(globals[readIndex()]); break;
+            case OP_SET_GLOBAL: globals[readIndex()] = peek(); break;
+            case OP_GET_LOCAL: push(stack[readSlot()]); break;
+            case OP_SET_LOCAL: stack[readSlot()] = peek(); break;
+
+            case OP_CLASS: classes.insert(readConstant().asHandle()); break;
+            case OP_NEW: {
+                const Value& name = readConstant();
+                if (!classes.count(name.asHandle())) throw std::runtime_error("Unknown class " + std::string(name.asString()));
+                size_t addr = heap.allocate<InstanceObject>(Shape::root(name.asHandle()));
+                push(Value::instance(addr));
+                break;
+            }
+            case OP_GET_FIELD: {
+                size_t name = readConstant().asHandle();
+                InlineCache& ic = chunk->caches[readIndex()];
+                if (!peek().isInstance()) throw std::runtime_error("Only instances have properties.");
+                auto* io = static_cast<InstanceObject*>(heap.get(peek().asHandle()));
+                peek() = ic.get(io, name);
+                break;
+            }
+            case OP_SET_FIELD: {
+                size_t name = readConstant().asHandle();
+                InlineCache& ic = chunk->caches[readIndex()];
+                if (!peek(1).isInstance()) throw std::runtime_error("Only instances have fields.");
+                auto* io = static_cast<InstanceObject*>(heap.get(peek(1).asHandle()));
+                ic.set(io, name, peek());
+                Value value = pop();
+                peek() = std::move(value);
+                break;
+            }
+
+            case OP_ADD: {
+                observe();
+                if (peek(0).isNumber() && peek(1).isNumber()) {
+                    double b = pop().asNumber();
+                    peek() = Value::number(peek().asNumber() + b);
+                } else if (peek(0).isString() && peek(1).isString()) {
+                    Value b = pop();
+                    peek() = Value::string(std::string(peek().asString()) + std::string(b.asString()));
+                } else {
+                    throw std::runtime_error("Operands must be two numbers or two strings.");
+                }
+                break;
+            }
+            case OP_SUBTRACT: { NUMERIC_OPERANDS(); push(Value::number(a - b)); break; }
+            case OP_MULTIPLY: { NUMERIC_OPERANDS(); push(Value::number(a * b)); break; }
+            case OP_DIVIDE:   { NUMERIC_OPERANDS(); push(Value::number(a / b)); break; }
+            case OP_NEGATE:
+                if (!peek().isNumber()) throw std::runtime_error("Operand must be a number.");
+                peek() = Value::number(-peek().asNumber());
+                break;
+            case OP_NOT: peek() = Value::boolean(!peek().isTruthy()); break;
+
+            case OP_EQUAL:     { Value b = pop(); peek() = Value::boolean(peek() == b); break; }
+            case OP_NOT_EQUAL: { Value b = pop(); peek() = Value::boolean(!(peek() == b)); break; }
+            case OP_GREATER:       { NUMERIC_OPERANDS(); push(Value::boolean(a > b)); break; }
+            case OP_GREATER_EQUAL: { NUMERIC_OPERANDS(); push(Value::boolean(a >= b)); break; }
+            case OP_LESS:          { NUMERIC_OPERANDS(); push(Value::boolean(a < b)); break; }
+            case OP_LESS_EQUAL:    { NUMERIC_OPERANDS(); push(Value::boolean(a <= b)); break; }
+
+            case OP_ADD_NUM:      { QUICK_NUMERIC(OP_ADD);      a = Value::number(a.asNumber() + b); break; }
+            case OP_SUBTRACT_NUM: { QUICK_NUMERIC(OP_SUBTRACT); a = Value::number(a.asNumber() - b); break; }
+            case OP_MULTIPLY_NUM: { QUICK_NUMERIC(OP_MULTIPLY); a = Value::number(a.asNumber() * b); break; }
+            case OP_DIVIDE_NUM:   { QUICK_NUMERIC(OP_DIVIDE);   a = Value::number(a.asNumber() / b); break; }
+            case OP_GREATER_NUM:       { QUICK_NUMERIC(OP_GREATER);       a = Value::boolean(a.asNumber() > b); break; }
+            case OP_GREATER_EQUAL_NUM: { QUICK_NUMERIC(OP_GREATER_EQUAL); a = Value::boolean(a.asNumber() >= b); break; }
+            case OP_LESS_NUM:          { QUICK_NUMERIC(OP_LESS);          a = Value::boolean(a.asNumber() < b); break; }
+            case OP_LESS_EQUAL_NUM:    { QUICK_NUMERIC(OP_LESS_EQUAL);    a = Value::boolean(a.asNumber() <= b); break; }
+            case OP_ADD_STR: {
+                if (!peek(0).isString() || !peek(1).isString()) {
+                    deoptimize(OP_ADD);
+                    break;
+                }
+                chunk->feedback[readIndex()].hits++;
+                Value b = pop();
+                peek() = Value::string(std::string(peek().asString()) + std::string(b.asString()));
+                break;
+            }
+
+            case OP_JUMP_IF_FALSE: {
+                size_t offset = readIndex();
+                if (!pop().isTruthy()) ip += offset;
+                break;
+            }
+            case OP_LOOP: {
+                size_t offset = readIndex();
+                ip -= offset;
+                break;
+            }
+
+            case OP_PRINT:
+                out << pop().toString() << "\n";
+                break;
+            case OP_RETURN:
+                return;
+            default:
+                throw std::runtime_error("Unknown opcode at line " + std::to_string(currentLine()) + ".");
+        }
+    }
+#undef NUMERIC_OPERANDS
+#undef QUICK_NUMERIC
+}